@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "histogram.h"
+#include "pgm_io.h"
+#include "bounded_queue.h"
+
+#define DEFAULT_READERS 2   // Disk reads in flight
+#define DEFAULT_PARSERS 2   // Header / P2 decode threads
+#define JOBS_PER_WORKER 2   // Recycled image buffers per histogram worker
+
+// One image travelling through the pipeline. Jobs are allocated once and
+// recycled through the pool, so the raw and decoded buffers keep their
+// capacity from image to image.
+struct ImageJob {
+    std::string path;
+    std::vector<char> raw;
+    std::vector<unsigned char> decoded;
+    const unsigned char *pixels = nullptr;
+    PGMHeader header;
+    std::array<int, MAX_INTENSITY> histogram;
+    bool ok = false;
+};
+
+using JobQueue = BoundedQueue<ImageJob *>; // nullptr marks end of stream
+
+// Function to collect the input images: every *.pgm in a directory (sorted),
+// or one path per line of a list file
+std::vector<std::string> listInputs(const std::string &source) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    if (std::filesystem::is_directory(source, error)) {
+        for (const auto &entry : std::filesystem::directory_iterator(source, error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".pgm") {
+                paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    std::ifstream file(source);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open input list " << source << std::endl;
+        return {};
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) paths.push_back(line);
+    }
+    return paths;
+}
+
+// Function to read a whole file into a reusable buffer
+bool readFile(const std::string &path, std::vector<char> &raw) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::streamsize bytes = file.tellg();
+    file.seekg(0);
+    raw.resize(static_cast<std::size_t>(bytes));
+    return static_cast<bool>(file.read(raw.data(), bytes));
+}
+
+// Function to signal end of stream once the last thread of a stage finishes
+void finishStage(std::atomic<int> &remaining, JobQueue &next, int consumers) {
+    if (remaining.fetch_sub(1) == 1) {
+        for (int i = 0; i < consumers; i++) next.push(nullptr);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <input_dir|list_file> <output_file> [num_workers] [num_readers]" << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> paths = listInputs(argv[1]);
+    if (paths.empty()) {
+        std::cerr << "ERROR: No input images found.\n";
+        return -1;
+    }
+    std::ofstream output(argv[2]);
+    if (!output.is_open()) {
+        std::cerr << "ERROR: Could not open output file.\n";
+        return -1;
+    }
+
+    int workers = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int readers = argc > 4 ? std::atoi(argv[4]) : DEFAULT_READERS;
+    int parsers = DEFAULT_PARSERS;
+    workers = std::max(1, workers);
+    readers = std::max(1, readers);
+
+    // Bounded pool: readers stall once every buffer is in flight, which caps memory
+    const int numJobs = JOBS_PER_WORKER * workers + readers + parsers;
+    const std::size_t capacity = static_cast<std::size_t>(numJobs + std::max(parsers, workers) + 1);
+    std::vector<ImageJob> jobs(numJobs);
+    JobQueue pool(capacity), parseQueue(capacity), histogramQueue(capacity), outputQueue(capacity);
+    for (ImageJob &job : jobs) pool.push(&job);
+
+    std::atomic<std::size_t> nextPath{0};
+    std::atomic<int> readersLeft{readers}, parsersLeft{parsers}, workersLeft{workers};
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&] {
+            std::size_t i;
+            while ((i = nextPath.fetch_add(1)) < paths.size()) {
+                ImageJob *job = pool.pop();
+                job->path = paths[i];
+                job->ok = readFile(job->path, job->raw);
+                parseQueue.push(job);
+            }
+            finishStage(readersLeft, parseQueue, parsers);
+        });
+    }
+
+    for (int p = 0; p < parsers; p++) {
+        threads.emplace_back([&] {
+            while (ImageJob *job = parseQueue.pop()) {
+                if (job->ok) {
+                    const char *begin = job->raw.data();
+                    job->ok = decodePGM(begin, begin + job->raw.size(), job->header, job->decoded, job->pixels);
+                }
+                histogramQueue.push(job);
+            }
+            finishStage(parsersLeft, histogramQueue, workers);
+        });
+    }
+
+    for (int w = 0; w < workers; w++) {
+        threads.emplace_back([&] {
+            while (ImageJob *job = histogramQueue.pop()) {
+                if (job->ok) {
+                    computeHistogram(job->pixels, static_cast<std::size_t>(job->header.width) * job->header.height, job->histogram);
+                }
+                outputQueue.push(job);
+            }
+            finishStage(workersLeft, outputQueue, 1);
+        });
+    }
+
+    // The main thread is the writer stage; results appear in completion order
+    std::size_t processed = 0, failed = 0, bytes = 0;
+    while (ImageJob *job = outputQueue.pop()) {
+        if (job->ok) {
+            output << job->path;
+            for (int i = 0; i < MAX_INTENSITY; i++) output << ' ' << job->histogram[i];
+            output << '\n';
+            processed++;
+            bytes += job->raw.size();
+        } else {
+            std::cerr << "ERROR: Skipping unreadable image " << job->path << std::endl;
+            failed++;
+        }
+        pool.push(job);
+    }
+    for (std::thread &thread : threads) thread.join();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Processed " << processed << " images (" << failed << " failed) in " << elapsed.count() << " s: "
+              << processed / elapsed.count() << " images/s, " << bytes / elapsed.count() / (1 << 20) << " MB/s.\n";
+    std::cout << "Histograms saved to " << argv[2] << ".\n";
+    return failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,174 @@
+#ifndef BFS_H
+#define BFS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <omp.h>
+#include "csr_graph.h"
+
+#define BFS_ALPHA 15 // Go bottom-up once the frontier's edges exceed unexplored edges / alpha
+#define BFS_BETA 18  // Go back top-down once the frontier drops below vertices / beta
+#define BFS_BOTTOM_UP_CHUNK 1024 // Multiple of 64, so each bitmap word has a single writer
+
+struct BFSResult {
+    std::vector<std::int64_t> parent; // -1 when unreached; the root is its own parent
+    std::vector<std::int32_t> level;  // Hops from the root; -1 when unreached
+    vertex_t visited = 0;
+    edge_t traversedEdges = 0;        // Undirected edges inside the reached component
+    int levels = 0;
+    int bottomUpLevels = 0;
+};
+
+inline bool claimParent(std::int64_t *slot, std::int64_t parent) {
+    std::int64_t unvisited = -1;
+    return __atomic_compare_exchange_n(slot, &unvisited, parent, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+inline bool testBit(const std::vector<std::uint64_t> &bits, vertex_t v) {
+    return (bits[v >> 6] >> (v & 63)) & 1;
+}
+
+// Function to run a direction-optimizing BFS over a whole undirected graph
+// (firstVertex 0). Top-down levels expand the frontier list and claim
+// children with a CAS on parent[]; once the frontier touches a large share
+// of the remaining edges, bottom-up levels let every unvisited vertex look
+// for any parent in a frontier bitmap and stop at the first hit. The switch
+// follows Beamer's alpha/beta heuristic.
+inline BFSResult parallelBFS(const CSRView &graph, vertex_t root) {
+    const vertex_t n = graph.numVertices;
+    BFSResult result;
+    result.parent.assign(n, -1);
+    result.level.assign(n, -1);
+    std::int64_t *parent = result.parent.data();
+    std::int32_t *level = result.level.data();
+    parent[root] = root;
+    level[root] = 0;
+
+    std::vector<vertex_t> frontier(1, root), next;
+    std::vector<std::uint64_t> frontierBits((static_cast<std::size_t>(n) + 63) / 64), nextBits(frontierBits.size());
+    edge_t frontierEdges = graph.degree(root);
+    edge_t unexplored = graph.numEdges() - frontierEdges;
+    vertex_t frontierSize = 1;
+    bool bottomUp = false;
+
+    for (int depth = 0; frontierSize > 0; depth++) {
+        const bool wasBottomUp = bottomUp;
+        if (!bottomUp && frontierEdges > unexplored / BFS_ALPHA) bottomUp = true;
+        else if (bottomUp && frontierSize < n / BFS_BETA) bottomUp = false;
+
+        // Convert the frontier when the direction changes
+        if (bottomUp && !wasBottomUp) {
+            std::fill(frontierBits.begin(), frontierBits.end(), 0);
+            for (vertex_t v : frontier) frontierBits[v >> 6] |= std::uint64_t(1) << (v & 63);
+        } else if (!bottomUp && wasBottomUp) {
+            frontier.clear();
+            for (std::size_t w = 0; w < frontierBits.size(); w++) {
+                for (std::uint64_t word = frontierBits[w]; word != 0; word &= word - 1) {
+                    frontier.push_back(static_cast<vertex_t>(w * 64 + __builtin_ctzll(word)));
+                }
+            }
+        }
+
+        edge_t nextEdges = 0;
+        vertex_t nextSize = 0;
+        if (bottomUp) {
+            std::fill(nextBits.begin(), nextBits.end(), 0);
+            #pragma omp parallel for schedule(dynamic, BFS_BOTTOM_UP_CHUNK) reduction(+ : nextEdges, nextSize)
+            for (long long i = 0; i < static_cast<long long>(n); i++) {
+                const vertex_t v = static_cast<vertex_t>(i);
+                if (parent[v] != -1) continue;
+                for (const vertex_t *u = graph.begin(v); u != graph.end(v); u++) {
+                    if (testBit(frontierBits, *u)) {
+                        parent[v] = *u;
+                        level[v] = depth + 1;
+                        nextBits[v >> 6] |= std::uint64_t(1) << (v & 63);
+                        nextEdges += graph.degree(v);
+                        nextSize++;
+                        break;
+                    }
+                }
+            }
+            frontierBits.swap(nextBits);
+            result.bottomUpLevels++;
+        } else {
+            next.clear();
+            #pragma omp parallel reduction(+ : nextEdges)
+            {
+                std::vector<vertex_t> found;
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (long long i = 0; i < static_cast<long long>(frontier.size()); i++) {
+                    const vertex_t u = frontier[i];
+                    for (const vertex_t *v = graph.begin(u); v != graph.end(u); v++) {
+                        if (parent[*v] == -1 && claimParent(&parent[*v], u)) {
+                            level[*v] = depth + 1;
+                            nextEdges += graph.degree(*v);
+                            found.push_back(*v);
+                        }
+                    }
+                }
+                #pragma omp critical
+                next.insert(next.end(), found.begin(), found.end());
+            }
+            frontier.swap(next);
+            nextSize = static_cast<vertex_t>(frontier.size());
+        }
+
+        result.visited += frontierSize;
+        unexplored -= std::min(unexplored, nextEdges);
+        frontierEdges = nextEdges;
+        frontierSize = nextSize;
+        result.levels = depth + 1;
+    }
+
+    edge_t reachedDegree = 0;
+    #pragma omp parallel for schedule(static) reduction(+ : reachedDegree)
+    for (long long v = 0; v < static_cast<long long>(n); v++) {
+        if (parent[v] != -1) reachedDegree += graph.degree(static_cast<vertex_t>(v));
+    }
+    result.traversedEdges = reachedDegree / 2;
+    return result;
+}
+
+// Function to check a BFS tree over the rows of `rows`. `parent` is indexed
+// by row, `level` by global vertex id. Together these checks pin every
+// level to the true BFS distance: the root is at level 0 and its own parent,
+// each tree edge exists and climbs exactly one level, and no graph edge
+// spans more than one level or joins a reached vertex to an unreached one.
+// Rows must be sorted (buildCSR guarantees it). Returns the number of errors.
+inline long long checkBFSRows(const CSRView &rows, const std::int64_t *parent, const std::int32_t *level, vertex_t root) {
+    long long errors = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : errors)
+    for (long long i = 0; i < static_cast<long long>(rows.numVertices); i++) {
+        const vertex_t row = static_cast<vertex_t>(i);
+        const vertex_t v = rows.firstVertex + row;
+        const std::int32_t depth = level[v];
+        if (v == root) {
+            errors += parent[row] != root || depth != 0;
+            continue;
+        }
+        if ((parent[row] == -1) != (depth == -1)) {
+            errors++;
+            continue;
+        }
+        if (parent[row] != -1) {
+            const vertex_t p = static_cast<vertex_t>(parent[row]);
+            errors += !std::binary_search(rows.begin(row), rows.end(row), p) || level[p] != depth - 1;
+        }
+        for (const vertex_t *u = rows.begin(row); u != rows.end(row); u++) {
+            const std::int32_t other = level[*u];
+            if ((depth == -1) != (other == -1)) errors++;
+            else if (depth != -1 && (other > depth + 1 || other < depth - 1)) errors++;
+        }
+    }
+    return errors;
+}
+
+// Function to summarise per-root TEPS rates the Graph500 way: harmonic mean
+inline double harmonicMean(const std::vector<double> &rates) {
+    double inverse = 0.0;
+    for (double rate : rates) inverse += 1.0 / rate;
+    return rates.empty() ? 0.0 : rates.size() / inverse;
+}
+
+#endif // BFS_H
@@ -0,0 +1,107 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+#define QUEUE_SPIN_LIMIT 64 // Failed attempts before a blocked producer/consumer starts sleeping
+
+// Fixed-capacity multi-producer/multi-consumer queue without locks. Every
+// cell carries a sequence number: producers claim a slot by CAS on the
+// enqueue position and publish by bumping the cell's sequence, consumers do
+// the mirror image. Capacity is rounded up to a power of two.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells = std::vector<Cell>(size);
+        mask = size - 1;
+        for (std::size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    bool tryPush(const T &value) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T &value) {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Blocking variants: spin briefly, then back off so idle stages do not
+    // burn the cores the compute stages need
+    void push(const T &value) {
+        for (int attempt = 0; !tryPush(value); attempt++) backOff(attempt);
+    }
+
+    T pop() {
+        T value;
+        for (int attempt = 0; !tryPop(value); attempt++) backOff(attempt);
+        return value;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    static void backOff(int attempt) {
+        if (attempt < QUEUE_SPIN_LIMIT) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    std::vector<Cell> cells;
+    std::size_t mask = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> enqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> dequeuePos{0};
+};
+
+#endif // BOUNDED_QUEUE_H
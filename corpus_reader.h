@@ -0,0 +1,106 @@
+#ifndef CORPUS_READER_H
+#define CORPUS_READER_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "mapped_file.h"
+#include "pgm_mpiio.h"
+
+// Byte classes for the tokenizer. Word bytes are 'A' through 'z', the same
+// range the search's letter_only facet has always used (so [\]^_` count as
+// letters); every other byte separates words.
+struct WordTable {
+    bool word[256];
+
+    constexpr WordTable() : word() {
+        for (int c = 'A'; c <= 'z'; c++) word[c] = true;
+    }
+};
+
+inline constexpr WordTable WORD_TABLE;
+
+inline bool isWordByte(char c) {
+    return WORD_TABLE.word[static_cast<unsigned char>(c)];
+}
+
+// Function to step to the next word in [pos, end). On success `word` and
+// `length` describe it and `pos` is left just past it.
+inline bool nextWord(const char *&pos, const char *end, const char *&word, std::size_t &length) {
+    while (pos < end && !isWordByte(*pos)) pos++;
+    word = pos;
+    while (pos < end && isWordByte(*pos)) pos++;
+    length = static_cast<std::size_t>(pos - word);
+    return length > 0;
+}
+
+// Function to call visit(word, length) for each word in [begin, end). The
+// words point into the buffer, so nothing is copied or allocated.
+template <typename Visitor>
+inline void forEachWord(const char *begin, const char *end, Visitor &&visit) {
+    const char *word;
+    std::size_t length;
+    while (nextWord(begin, end, word, length)) visit(word, length);
+}
+
+// Function to move `position` forward out of any word it splits, so a word
+// always belongs to the range holding its first byte
+inline std::size_t alignToWord(const char *data, std::size_t size, std::size_t position) {
+    if (position == 0) return 0;
+    while (position < size && isWordByte(data[position - 1]) && isWordByte(data[position])) position++;
+    return std::min(position, size);
+}
+
+// One rank's share of a corpus: the whole file is mapped, and [begin, end)
+// is this rank's byte range with both ends moved to word boundaries
+struct CorpusSlice {
+    MappedFile file;
+    const char *begin = nullptr;
+    const char *end = nullptr;
+};
+
+// Function for every rank to map the corpus and take its own word-aligned
+// byte range. Nothing is read on rank 0's behalf and nothing is sent.
+// Returns false on every rank if any rank could not map the file.
+inline bool openCorpusSlice(const std::string &filename, MPI_Comm comm, CorpusSlice &slice) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int ok = slice.file.open(filename), allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    if (!allOk) return false;
+
+    std::size_t offset, length;
+    slabRange(slice.file.size(), size, rank, offset, length);
+    const char *data = slice.file.data();
+    slice.begin = data + alignToWord(data, slice.file.size(), offset);
+    slice.end = data + alignToWord(data, slice.file.size(), offset + length);
+    return true;
+}
+
+// Function to cut [begin, end), which starts on a word boundary, into
+// `parts` word-aligned pieces and give piece `part`, e.g. one per thread
+inline void splitCorpusRange(const char *begin, const char *end, int parts, int part, const char *&pieceBegin, const char *&pieceEnd) {
+    const std::size_t size = static_cast<std::size_t>(end - begin);
+    std::size_t offset, length;
+    slabRange(size, parts, part, offset, length);
+    pieceBegin = begin + alignToWord(begin, size, offset);
+    pieceEnd = begin + alignToWord(begin, size, offset + length);
+}
+
+// Function to fault in every page of a slice on `threads` threads, so the
+// scan that follows is timed without the file reads. Returns a byte sum to
+// keep the loads alive.
+inline unsigned long loadCorpusSlice(const CorpusSlice &slice, int threads = 1) {
+    const std::ptrdiff_t page = static_cast<std::ptrdiff_t>(sysconf(_SC_PAGESIZE));
+    const std::ptrdiff_t pages = (slice.end - slice.begin + page - 1) / page;
+    unsigned long sum = 0;
+    #pragma omp parallel for num_threads(threads) schedule(static) reduction(+ : sum)
+    for (std::ptrdiff_t p = 0; p < pages; p++) sum += static_cast<unsigned char>(slice.begin[p * page]);
+    return sum;
+}
+
+#endif // CORPUS_READER_H
@@ -0,0 +1,310 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mapped_file.h"
+
+#define GRAPH_MAGIC "CSRGRAPH"        // First 8 bytes of a binary graph file
+#define EDGE_PARSE_GRAIN (1 << 20)    // Minimum bytes of edge-list text handed to one parser thread
+
+using vertex_t = std::uint32_t;
+using edge_t = std::uint64_t;
+
+struct Edge {
+    vertex_t u, v;
+};
+
+// Read-only compressed sparse row adjacency. Row i describes vertex
+// firstVertex + i; its neighbours (global ids) are
+// targets[offsets[i] .. offsets[i + 1]). offsets[0] need not be 0, so a view
+// can cover a slice of a larger graph without copying.
+struct CSRView {
+    vertex_t numVertices = 0;   // Rows in this view
+    vertex_t firstVertex = 0;   // Global id of row 0
+    const edge_t *offsets = nullptr;
+    const vertex_t *targets = nullptr;
+
+    edge_t degree(vertex_t row) const { return offsets[row + 1] - offsets[row]; }
+    edge_t numEdges() const { return numVertices == 0 ? 0 : offsets[numVertices] - offsets[0]; }
+    const vertex_t *begin(vertex_t row) const { return targets + offsets[row]; }
+    const vertex_t *end(vertex_t row) const { return targets + offsets[row + 1]; }
+};
+
+// A CSR graph that owns its arrays. Undirected graphs store every edge in
+// both directions.
+struct CSRGraph {
+    vertex_t numVertices = 0;
+    vertex_t firstVertex = 0;
+    std::vector<edge_t> offsets;
+    std::vector<vertex_t> targets;
+
+    CSRView view() const {
+        CSRView view;
+        view.numVertices = numVertices;
+        view.firstVertex = firstVertex;
+        view.offsets = offsets.data();
+        view.targets = targets.data();
+        return view;
+    }
+};
+
+// Function to build CSR rows [firstRow, firstRow + numRows) from an edge list
+// whose sources all fall in that range. With `symmetrize` (whole graphs only,
+// firstRow == 0) every edge is also stored reversed. Self-loops and duplicate
+// edges are dropped and each row ends up sorted. Degrees are counted and
+// rows filled with atomics, so the build is one parallel pass over the edges.
+inline CSRGraph buildCSR(vertex_t numRows, vertex_t firstRow, const std::vector<Edge> &edges, bool symmetrize) {
+    CSRGraph graph;
+    graph.numVertices = numRows;
+    graph.firstVertex = firstRow;
+    const long long count = static_cast<long long>(edges.size());
+
+    std::vector<edge_t> cursor(static_cast<std::size_t>(numRows) + 1, 0);
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < count; i++) {
+        const Edge &e = edges[i];
+        if (e.u == e.v) continue;
+        #pragma omp atomic
+        cursor[e.u - firstRow + 1]++;
+        if (symmetrize) {
+            #pragma omp atomic
+            cursor[e.v + 1]++;
+        }
+    }
+    for (vertex_t r = 0; r < numRows; r++) cursor[r + 1] += cursor[r];
+    std::vector<edge_t> start(cursor);
+    std::vector<vertex_t> filled(cursor[numRows]);
+
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < count; i++) {
+        const Edge &e = edges[i];
+        if (e.u == e.v) continue;
+        edge_t slot;
+        #pragma omp atomic capture
+        slot = cursor[e.u - firstRow]++;
+        filled[slot] = e.v;
+        if (symmetrize) {
+            #pragma omp atomic capture
+            slot = cursor[e.v]++;
+            filled[slot] = e.u;
+        }
+    }
+
+    // Sort and deduplicate each row, then compact
+    graph.offsets.assign(static_cast<std::size_t>(numRows) + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (long long r = 0; r < static_cast<long long>(numRows); r++) {
+        vertex_t *first = filled.data() + start[r];
+        vertex_t *last = filled.data() + start[r + 1];
+        std::sort(first, last);
+        graph.offsets[r + 1] = static_cast<edge_t>(std::unique(first, last) - first);
+    }
+    for (vertex_t r = 0; r < numRows; r++) graph.offsets[r + 1] += graph.offsets[r];
+    graph.targets.resize(graph.offsets[numRows]);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (long long r = 0; r < static_cast<long long>(numRows); r++) {
+        std::copy(filled.data() + start[r], filled.data() + start[r] + (graph.offsets[r + 1] - graph.offsets[r]),
+                  graph.targets.data() + graph.offsets[r]);
+    }
+    return graph;
+}
+
+// Function to parse "u v" lines (further columns such as weights are
+// ignored; lines starting with '#' or '%' are comments) from [begin, end).
+// The text is split at line breaks over up to hardware_concurrency threads,
+// each parsing with std::from_chars into its own buffer. `numVertices`
+// becomes one more than the largest id seen.
+inline bool parseEdgeList(const char *begin, const char *end, std::vector<Edge> &edges, vertex_t &numVertices) {
+    int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int parts = static_cast<int>(std::min<std::size_t>(hardware, static_cast<std::size_t>(end - begin) / EDGE_PARSE_GRAIN + 1));
+    std::vector<const char *> bounds(parts + 1, end);
+    bounds[0] = begin;
+    for (int t = 1; t < parts; t++) {
+        const char *pos = std::max(bounds[t - 1], begin + (end - begin) * t / parts);
+        while (pos < end && *pos != '\n') pos++;
+        bounds[t] = pos < end ? pos + 1 : end;
+    }
+
+    std::vector<std::vector<Edge> > local(parts);
+    std::vector<vertex_t> largest(parts, 0);
+    std::vector<char> failed(parts, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < parts; t++) {
+        workers.emplace_back([&, t] {
+            const char *pos = bounds[t];
+            const char *stop = bounds[t + 1];
+            while (pos < stop) {
+                while (pos < stop && (*pos == ' ' || *pos == '\t' || *pos == '\r')) pos++;
+                const char *lineEnd = static_cast<const char *>(std::memchr(pos, '\n', stop - pos));
+                if (lineEnd == nullptr) lineEnd = stop;
+                if (pos < lineEnd && *pos != '#' && *pos != '%') {
+                    std::uint64_t ids[2];
+                    for (int k = 0; k < 2; k++) {
+                        while (pos < lineEnd && (*pos == ' ' || *pos == '\t' || *pos == ',')) pos++;
+                        auto result = std::from_chars(pos, lineEnd, ids[k]);
+                        if (result.ec != std::errc() || ids[k] >= UINT32_MAX) { failed[t] = 1; return; }
+                        pos = result.ptr;
+                    }
+                    local[t].push_back(Edge{static_cast<vertex_t>(ids[0]), static_cast<vertex_t>(ids[1])});
+                    largest[t] = std::max({largest[t], static_cast<vertex_t>(ids[0] + 1), static_cast<vertex_t>(ids[1] + 1)});
+                }
+                pos = lineEnd < stop ? lineEnd + 1 : stop;
+            }
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+        std::cerr << "ERROR: Malformed line in edge list.\n";
+        return false;
+    }
+
+    std::size_t total = 0;
+    for (const std::vector<Edge> &part : local) total += part.size();
+    edges.clear();
+    edges.reserve(total);
+    for (const std::vector<Edge> &part : local) edges.insert(edges.end(), part.begin(), part.end());
+    numVertices = *std::max_element(largest.begin(), largest.end());
+    return true;
+}
+
+// Function to read an undirected graph from an edge-list file
+inline bool loadEdgeList(const std::string &filename, CSRGraph &graph) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+    std::vector<Edge> edges;
+    vertex_t numVertices = 0;
+    if (!parseEdgeList(file.data(), file.data() + file.size(), edges, numVertices)) return false;
+    graph = buildCSR(numVertices, 0, edges, true);
+    return true;
+}
+
+// Function to read the dense 0/1 adjacency-matrix text used for the image
+// pipeline's topology (one row per line, as readAdjacencyMatrix expects).
+// Only the non-zero entries are kept, so memory is O(V + E) rather than O(V^2).
+inline bool loadAdjacencyMatrix(const std::string &filename, CSRGraph &graph) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open adjacency matrix file " << filename << std::endl;
+        return false;
+    }
+    std::vector<Edge> edges;
+    std::string line;
+    vertex_t row = 0, columns = 0;
+    while (std::getline(file, line)) {
+        const char *pos = line.data(), *end = line.data() + line.size();
+        vertex_t column = 0;
+        while (pos < end) {
+            while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) pos++;
+            int value;
+            auto result = std::from_chars(pos, end, value);
+            if (result.ec != std::errc()) break;
+            if (value != 0) edges.push_back(Edge{row, column});
+            pos = result.ptr;
+            column++;
+        }
+        columns = std::max(columns, column);
+        row++;
+    }
+    graph = buildCSR(std::max(row, columns), 0, edges, true);
+    return true;
+}
+
+// Binary layout: the 8-byte magic, then numVertices and numEdges as uint64,
+// then offsets[numVertices + 1] (uint64) and targets[numEdges] (uint32), all
+// little-endian as written by this machine. Every array is 8-byte aligned, so
+// a mapped file is usable in place.
+struct GraphFileHeader {
+    char magic[8];
+    std::uint64_t numVertices;
+    std::uint64_t numEdges;
+};
+
+inline std::size_t graphOffsetsPosition() { return sizeof(GraphFileHeader); }
+inline std::size_t graphTargetsPosition(std::uint64_t numVertices) {
+    return sizeof(GraphFileHeader) + (numVertices + 1) * sizeof(edge_t);
+}
+
+// Function to write a whole graph (firstVertex 0) in the binary format
+inline bool writeBinaryGraph(const std::string &filename, const CSRView &graph) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open output file " << filename << std::endl;
+        return false;
+    }
+    GraphFileHeader header;
+    std::memcpy(header.magic, GRAPH_MAGIC, sizeof(header.magic));
+    header.numVertices = graph.numVertices;
+    header.numEdges = graph.numEdges();
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(graph.offsets), static_cast<std::streamsize>((header.numVertices + 1) * sizeof(edge_t)));
+    file.write(reinterpret_cast<const char *>(graph.targets), static_cast<std::streamsize>(header.numEdges * sizeof(vertex_t)));
+    return static_cast<bool>(file);
+}
+
+// A binary graph file mapped in place; views into it cost nothing to create
+class MappedGraph {
+public:
+    bool open(const std::string &filename) {
+        if (!file.open(filename, MADV_RANDOM)) return false;
+        if (file.size() < sizeof(GraphFileHeader)) {
+            std::cerr << "ERROR: " << filename << " is not a binary graph.\n";
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, GRAPH_MAGIC, sizeof(header.magic)) != 0 ||
+            header.numVertices >= UINT32_MAX || file.size() < graphTargetsPosition(header.numVertices) ||
+            header.numEdges > (file.size() - graphTargetsPosition(header.numVertices)) / sizeof(vertex_t) ||
+            offsets()[0] != 0 || offsets()[header.numVertices] != header.numEdges) {
+            std::cerr << "ERROR: " << filename << " is not a valid binary graph.\n";
+            file.close();
+            return false;
+        }
+        return true;
+    }
+
+    // Function to check that rows [first, first + count) have non-decreasing
+    // offsets and targets below numVertices, so views of them stay inside the
+    // file. open() only checks the header and the two outer offsets; callers
+    // check every row they will use once, before traversing.
+    bool checkRows(vertex_t first, vertex_t count) const {
+        const edge_t *rows = offsets();
+        const vertex_t *targets = reinterpret_cast<const vertex_t *>(file.data() + graphTargetsPosition(header.numVertices));
+        for (vertex_t v = first; v < first + count; v++) {
+            if (rows[v + 1] < rows[v] || rows[v + 1] > header.numEdges) return false;
+        }
+        for (edge_t e = rows[first]; e < rows[first + count]; e++) {
+            if (targets[e] >= header.numVertices) return false;
+        }
+        return true;
+    }
+
+    vertex_t numVertices() const { return static_cast<vertex_t>(header.numVertices); }
+
+    // Function to view rows [first, first + count) without copying
+    CSRView slice(vertex_t first, vertex_t count) const {
+        CSRView view;
+        view.numVertices = count;
+        view.firstVertex = first;
+        view.offsets = offsets() + first;
+        view.targets = reinterpret_cast<const vertex_t *>(file.data() + graphTargetsPosition(header.numVertices));
+        return view;
+    }
+
+    CSRView view() const { return slice(0, numVertices()); }
+
+private:
+    const edge_t *offsets() const { return reinterpret_cast<const edge_t *>(file.data() + graphOffsetsPosition()); }
+
+    MappedFile file;
+    GraphFileHeader header{};
+};
+
+#endif // CSR_GRAPH_H
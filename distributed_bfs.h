@@ -0,0 +1,329 @@
+#ifndef DISTRIBUTED_BFS_H
+#define DISTRIBUTED_BFS_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bfs.h"
+#include "csr_graph.h"
+#include "pgm_mpiio.h"
+#include "rmat_generator.h"
+
+// 1D partitioning: rank r owns vertices [r * blockSize, (r + 1) * blockSize)
+// and the full adjacency of each. blockSize is a multiple of 64 so every
+// rank's slice of a frontier bitmap is a whole number of words.
+struct DistributedGraph {
+    vertex_t numVertices = 0; // Whole graph
+    vertex_t blockSize = 0;
+    CSRView local;            // This rank's rows
+    CSRGraph owned;           // Row storage when built in memory
+    MappedGraph mapped;       // Row storage when mapped from a binary file
+
+    int owner(vertex_t v) const { return static_cast<int>(v / blockSize); }
+};
+
+// Function to fix the block size and this rank's row range for `numVertices`
+inline void partitionVertices(vertex_t numVertices, MPI_Comm comm, DistributedGraph &graph, vertex_t &first, vertex_t &count) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const std::uint64_t perRank = (static_cast<std::uint64_t>(numVertices) + size - 1) / size;
+    graph.numVertices = numVertices;
+    graph.blockSize = static_cast<vertex_t>(std::max<std::uint64_t>(64, (perRank + 63) / 64 * 64));
+    const std::uint64_t begin = std::min<std::uint64_t>(numVertices, static_cast<std::uint64_t>(rank) * graph.blockSize);
+    first = static_cast<vertex_t>(begin);
+    count = static_cast<vertex_t>(std::min<std::uint64_t>(numVertices, begin + graph.blockSize) - begin);
+}
+
+// Function to send every edge, in both directions, to the owner of its
+// source with one MPI_Alltoallv, then build the local rows
+inline void distributeEdges(const std::vector<Edge> &edges, vertex_t numVertices, MPI_Comm comm, DistributedGraph &graph) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    vertex_t first, count;
+    partitionVertices(numVertices, comm, graph, first, count);
+
+    std::vector<int> sendCounts(size, 0), recvCounts(size), sendDispls(size + 1, 0), recvDispls(size + 1, 0);
+    for (const Edge &e : edges) {
+        if (e.u == e.v) continue;
+        sendCounts[graph.owner(e.u)] += 2;
+        sendCounts[graph.owner(e.v)] += 2;
+    }
+    for (int r = 0; r < size; r++) sendDispls[r + 1] = sendDispls[r] + sendCounts[r];
+    std::vector<vertex_t> sendBuffer(sendDispls[size]);
+    std::vector<int> cursor(sendDispls.begin(), sendDispls.end() - 1);
+    for (const Edge &e : edges) {
+        if (e.u == e.v) continue;
+        int slot = cursor[graph.owner(e.u)];
+        sendBuffer[slot] = e.u;
+        sendBuffer[slot + 1] = e.v;
+        cursor[graph.owner(e.u)] += 2;
+        slot = cursor[graph.owner(e.v)];
+        sendBuffer[slot] = e.v;
+        sendBuffer[slot + 1] = e.u;
+        cursor[graph.owner(e.v)] += 2;
+    }
+
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+    for (int r = 0; r < size; r++) recvDispls[r + 1] = recvDispls[r] + recvCounts[r];
+    std::vector<Edge> received(recvDispls[size] / 2);
+    MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_UINT32_T,
+                  received.data(), recvCounts.data(), recvDispls.data(), MPI_UINT32_T, comm);
+
+    graph.owned = buildCSR(count, first, received, false);
+    graph.local = graph.owned.view();
+}
+
+// Function to generate an RMAT graph in parallel: each rank draws its share
+// of the edges, which are then shuffled to their owners
+inline void generateDistributedRMAT(int scale, int edgeFactor, std::uint64_t seed, MPI_Comm comm, DistributedGraph &graph) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const std::uint64_t totalEdges = static_cast<std::uint64_t>(edgeFactor) << scale;
+    std::size_t offset, length;
+    slabRange(totalEdges, size, rank, offset, length);
+    distributeEdges(generateRMAT(scale, offset, length, seed), static_cast<vertex_t>(std::uint64_t(1) << scale), comm, graph);
+}
+
+// Function to load an edge-list file in parallel: every rank maps the file
+// and parses only the lines that start inside its share of the bytes
+inline bool loadDistributedEdgeList(const std::string &filename, MPI_Comm comm, DistributedGraph &graph) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    MappedFile file;
+    int ok = file.open(filename), allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    if (!allOk) return false;
+
+    // A line belongs to the rank whose byte range holds its first character
+    auto lineStart = [&](std::size_t position) {
+        if (position == 0 || position >= file.size()) return std::min(position, file.size());
+        while (position < file.size() && file.data()[position - 1] != '\n') position++;
+        return position;
+    };
+    std::size_t offset, length;
+    slabRange(file.size(), size, rank, offset, length);
+    const char *begin = file.data() + lineStart(offset);
+    const char *end = file.data() + lineStart(offset + length);
+
+    std::vector<Edge> edges;
+    vertex_t localVertices = 0, numVertices = 0;
+    ok = begin >= end || parseEdgeList(begin, end, edges, localVertices);
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    if (!allOk) return false;
+    MPI_Allreduce(&localVertices, &numVertices, 1, MPI_UINT32_T, MPI_MAX, comm);
+    distributeEdges(edges, numVertices, comm, graph);
+    return true;
+}
+
+// Function to take this rank's rows straight from a mapped binary graph; no
+// copies. Each rank checks only its own rows, so the file is validated once.
+inline bool openDistributedBinary(const std::string &filename, MPI_Comm comm, DistributedGraph &graph) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    int ok = graph.mapped.open(filename), allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    if (!allOk) return false;
+    vertex_t first, count;
+    partitionVertices(graph.mapped.numVertices(), comm, graph, first, count);
+    ok = graph.mapped.checkRows(first, count);
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    if (!allOk) {
+        if (rank == 0) std::cerr << "ERROR: " << filename << " has out-of-range offsets or targets.\n";
+        return false;
+    }
+    graph.local = graph.mapped.slice(first, count);
+    return true;
+}
+
+// Function to write the distributed graph as one binary file. Each rank
+// places its offsets (rebased with MPI_Exscan) and targets directly with
+// collective MPI-IO; rank 0 writes the header.
+inline bool writeDistributedBinary(const std::string &filename, const DistributedGraph &graph, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    const CSRView &rows = graph.local;
+    unsigned long long localEdges = rows.numEdges(), edgePrefix = 0, totalEdges = 0;
+    MPI_Exscan(&localEdges, &edgePrefix, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+    if (rank == 0) edgePrefix = 0;
+    MPI_Allreduce(&localEdges, &totalEdges, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+
+    // The rank holding the last vertex also writes the closing offset
+    const bool last = rows.numVertices > 0 && rows.firstVertex + rows.numVertices == graph.numVertices;
+    std::vector<edge_t> offsets(rows.numVertices + (last ? 1 : 0));
+    for (std::size_t i = 0; i < offsets.size(); i++) offsets[i] = rows.offsets[i] - rows.offsets[0] + edgePrefix;
+
+    MPI_File file;
+    if (MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+        if (rank == 0) std::cerr << "ERROR: MPI-IO could not create " << filename << std::endl;
+        return false;
+    }
+    const std::size_t targetsAt = graphTargetsPosition(graph.numVertices);
+    MPI_File_set_size(file, static_cast<MPI_Offset>(targetsAt + totalEdges * sizeof(vertex_t)));
+    if (rank == 0) {
+        GraphFileHeader header;
+        std::memcpy(header.magic, GRAPH_MAGIC, sizeof(header.magic));
+        header.numVertices = graph.numVertices;
+        header.numEdges = totalEdges;
+        MPI_File_write_at(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+    bool ok = writeAtAll(file, static_cast<MPI_Offset>(graphOffsetsPosition() + rows.firstVertex * sizeof(edge_t)),
+                         reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(edge_t), comm);
+    ok &= writeAtAll(file, static_cast<MPI_Offset>(targetsAt + edgePrefix * sizeof(vertex_t)),
+                     reinterpret_cast<const char *>(rows.targets + rows.offsets[0]), localEdges * sizeof(vertex_t), comm);
+    MPI_File_close(&file);
+    return ok;
+}
+
+struct DistributedBFSResult {
+    std::vector<std::int64_t> parent; // Local rows; -1 when unreached
+    std::vector<std::int32_t> level;  // Local rows; -1 when unreached
+    vertex_t visited = 0;             // Whole graph
+    edge_t traversedEdges = 0;        // Whole graph, undirected
+    int levels = 0;
+    int bottomUpLevels = 0;
+};
+
+// Function to run a 1D-partitioned, direction-optimizing BFS. Top-down
+// levels send (child, parent) candidates for every frontier edge to the
+// child's owner with MPI_Alltoallv; bottom-up levels allgather the frontier
+// bitmap and let each rank's unvisited vertices search their own adjacency.
+// Every rank sees the same global frontier statistics, so all of them switch
+// direction at the same level.
+inline DistributedBFSResult distributedBFS(const DistributedGraph &graph, vertex_t root, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const CSRView &rows = graph.local;
+    const vertex_t first = rows.firstVertex;
+    const int words = static_cast<int>(graph.blockSize / 64);
+
+    DistributedBFSResult result;
+    result.parent.assign(rows.numVertices, -1);
+    result.level.assign(rows.numVertices, -1);
+    std::vector<vertex_t> frontier, next;
+    if (graph.owner(root) == rank) {
+        result.parent[root - first] = root;
+        result.level[root - first] = 0;
+        frontier.push_back(root - first);
+    }
+
+    unsigned long long stats[2] = {frontier.empty() ? 0 : rows.degree(root - first), rows.numEdges()}, totals[2];
+    MPI_Allreduce(stats, totals, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+    edge_t frontierEdges = totals[0];
+    edge_t unexplored = totals[1] - frontierEdges;
+    vertex_t frontierSize = 1;
+    bool bottomUp = false;
+
+    std::vector<std::uint64_t> localBits(words), frontierBits(static_cast<std::size_t>(words) * size);
+    std::vector<int> sendCounts(size), recvCounts(size), sendDispls(size + 1), recvDispls(size + 1);
+    std::vector<Edge> sendBuffer, recvBuffer;
+
+    for (int depth = 0; frontierSize > 0; depth++) {
+        if (!bottomUp && frontierEdges > unexplored / BFS_ALPHA) bottomUp = true;
+        else if (bottomUp && frontierSize < graph.numVertices / BFS_BETA) bottomUp = false;
+
+        next.clear();
+        unsigned long long nextEdges = 0;
+        if (bottomUp) {
+            std::fill(localBits.begin(), localBits.end(), 0);
+            for (vertex_t v : frontier) localBits[v >> 6] |= std::uint64_t(1) << (v & 63);
+            MPI_Allgather(localBits.data(), words, MPI_UINT64_T, frontierBits.data(), words, MPI_UINT64_T, comm);
+
+            std::vector<char> found(rows.numVertices, 0);
+            #pragma omp parallel for schedule(dynamic, BFS_BOTTOM_UP_CHUNK)
+            for (long long i = 0; i < static_cast<long long>(rows.numVertices); i++) {
+                const vertex_t v = static_cast<vertex_t>(i);
+                if (result.parent[v] != -1) continue;
+                for (const vertex_t *u = rows.begin(v); u != rows.end(v); u++) {
+                    if (testBit(frontierBits, *u)) {
+                        result.parent[v] = *u;
+                        result.level[v] = depth + 1;
+                        found[v] = 1;
+                        break;
+                    }
+                }
+            }
+            for (vertex_t v = 0; v < rows.numVertices; v++) {
+                if (found[v]) {
+                    next.push_back(v);
+                    nextEdges += rows.degree(v);
+                }
+            }
+            result.bottomUpLevels++;
+        } else {
+            std::fill(sendCounts.begin(), sendCounts.end(), 0);
+            for (vertex_t u : frontier) {
+                for (const vertex_t *v = rows.begin(u); v != rows.end(u); v++) sendCounts[graph.owner(*v)]++;
+            }
+            sendDispls[0] = 0;
+            for (int r = 0; r < size; r++) sendDispls[r + 1] = sendDispls[r] + sendCounts[r];
+            sendBuffer.resize(sendDispls[size]);
+            std::vector<int> cursor(sendDispls.begin(), sendDispls.end() - 1);
+            for (vertex_t u : frontier) {
+                for (const vertex_t *v = rows.begin(u); v != rows.end(u); v++) {
+                    sendBuffer[cursor[graph.owner(*v)]++] = Edge{*v, first + u};
+                }
+            }
+
+            MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+            recvDispls[0] = 0;
+            for (int r = 0; r < size; r++) recvDispls[r + 1] = recvDispls[r] + recvCounts[r];
+            recvBuffer.resize(recvDispls[size]);
+            // Edges travel as pairs of uint32; scale the counts accordingly
+            for (int r = 0; r <= size; r++) {
+                if (r < size) { sendCounts[r] *= 2; recvCounts[r] *= 2; }
+                sendDispls[r] *= 2;
+                recvDispls[r] *= 2;
+            }
+            MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_UINT32_T,
+                          recvBuffer.data(), recvCounts.data(), recvDispls.data(), MPI_UINT32_T, comm);
+
+            for (const Edge &candidate : recvBuffer) {
+                const vertex_t v = candidate.u - first;
+                if (result.parent[v] != -1) continue;
+                result.parent[v] = candidate.v;
+                result.level[v] = depth + 1;
+                next.push_back(v);
+                nextEdges += rows.degree(v);
+            }
+        }
+        frontier.swap(next);
+
+        unsigned long long levelStats[2] = {frontier.size(), nextEdges}, levelTotals[2];
+        MPI_Allreduce(levelStats, levelTotals, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+        result.visited += frontierSize;
+        frontierSize = static_cast<vertex_t>(levelTotals[0]);
+        frontierEdges = levelTotals[1];
+        unexplored -= std::min<edge_t>(unexplored, frontierEdges);
+        result.levels = depth + 1;
+    }
+
+    unsigned long long reachedDegree = 0, totalDegree = 0;
+    for (vertex_t v = 0; v < rows.numVertices; v++) {
+        if (result.parent[v] != -1) reachedDegree += rows.degree(v);
+    }
+    MPI_Allreduce(&reachedDegree, &totalDegree, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+    result.traversedEdges = totalDegree / 2;
+    return result;
+}
+
+// Function to validate a distributed BFS: the levels are allgathered so each
+// rank can run checkBFSRows over its own rows. Returns the global error count.
+inline long long validateDistributedBFS(const DistributedGraph &graph, const DistributedBFSResult &result, vertex_t root, MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    std::vector<std::int32_t> localLevels(graph.blockSize, -1), levels(static_cast<std::size_t>(graph.blockSize) * size);
+    std::copy(result.level.begin(), result.level.end(), localLevels.begin());
+    MPI_Allgather(localLevels.data(), static_cast<int>(graph.blockSize), MPI_INT32_T,
+                  levels.data(), static_cast<int>(graph.blockSize), MPI_INT32_T, comm);
+    long long errors = checkBFSRows(graph.local, result.parent.data(), levels.data(), root), total = 0;
+    MPI_Allreduce(&errors, &total, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    return total;
+}
+
+#endif // DISTRIBUTED_BFS_H
@@ -4,121 +4,445 @@
 #include <cstdlib>
 #include <ctime>
 #include <cctype>
-#include <fstream>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <cstring>
+#include <iomanip>
+#include <memory>
+#include <omp.h>
+#include "corpus_reader.h"
+#include "node_topology.h"
+#include "query_automaton.h"
+#include "reduction.h"
+#include "word_count.h"
+#include "word_index.h"
+#include "word_match.h"
+#include "word_sketch.h"
+#include "word_stream.h"
 
-const static int ARRAY_SIZE = 130000;
-using Lines = char[ARRAY_SIZE][16];
+void DoOutput(std::string word, long long result)
+{
+    std::cout << "Word Frequency: " << word << " -> " << result << std::endl;
+}
 
-struct letter_only: std::ctype<char> 
+long long countFrequency(const WordBatch& batch, const std::string& word, int threads)
 {
-    letter_only(): std::ctype<char>(get_table()) {}
+    long long freq = 0;
+    #pragma omp parallel for num_threads(threads) schedule(static) reduction(+ : freq)
+    for (std::int64_t i = 0; i < static_cast<std::int64_t>(batch.count); i++) {
+        if (batch.length(i) == word.size() && memcmp(batch.word(i), word.data(), word.size()) == 0)
+            freq++;
+    }
+    return freq;
+}
 
-    static std::ctype_base::mask const* get_table()
-    {
-        static std::vector<std::ctype_base::mask> 
-            rc(std::ctype<char>::table_size, std::ctype_base::space);
-        std::fill(&rc['A'], &rc['z' + 1], std::ctype_base::alpha);
-        return &rc[0];
+// Full word count: every rank maps its words into a local hash table, entries are
+// shuffled by hash to owner ranks, and each owner writes its words to <prefix>.<rank>.
+// With build_index the owners write index shards instead and the corpus is appended
+// to the index at <prefix> as a new segment.
+int WordCount(const std::string& path, const std::string& prefix, const std::string& ingest, bool build_index, int processId, int numberOfProcesses)
+{
+    WordCountTable local, owned;
+    double start_time = MPI_Wtime();
+    
+    long long segment = 0;
+    if (build_index) {
+        std::vector<IndexSegment> segments;
+        if (processId == 0) segment = readManifest(prefix, segments) ? static_cast<long long>(segments.size()) : -1;
+        MPI_Bcast(&segment, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+        if (segment < 0) return 1;
     }
-};
+    
+    if (ingest == "mmap") {
+        CorpusSlice slice;
+        if (!openCorpusSlice(path, MPI_COMM_WORLD, slice)) return 1;
+        countSliceWords(slice, local, owned, MPI_COMM_WORLD);
+    } else if (ingest == "stream") {
+        bool streamed = streamWords(path, 0, MPI_COMM_WORLD, [&](const WordBatch& batch) {
+            for (std::uint32_t i = 0; i < batch.count; i++) local.add(batch.word(i), batch.length(i));
+            shuffleIfFull(local, owned, false, MPI_COMM_WORLD);
+        });
+        if (!streamed) return 1;
+        shuffleIfFull(local, owned, true, MPI_COMM_WORLD);
+    } else {
+        if (processId == 0) std::cout << "ERROR: Unknown ingest mode " << ingest << ". Use mmap or stream." << std::endl;
+        return 0;
+    }
+    
+    unsigned long long totals[2] = {owned.size(), 0}, global_totals[2];
+    owned.forEach([&](const char*, std::size_t, std::uint64_t, std::uint64_t count) { totals[1] += count; });
+    int written = build_index ? writeIndexShard(owned, shardPath(prefix, segment, processId))
+                              : writeWordCounts(owned, prefix + "." + std::to_string(processId));
+    int all_written = 0;
+    double elapsed = MPI_Wtime() - start_time, slowest = 0.0;
+    MPI_Reduce(totals, global_totals, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Allreduce(&written, &all_written, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (build_index && all_written && processId == 0) {
+        // The segment becomes visible only now that every shard is on disk
+        all_written = appendManifest(prefix, IndexSegment{numberOfProcesses, path});
+    }
+    MPI_Bcast(&all_written, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    
+    if (processId == 0) {
+        std::cout << "Distinct words: " << global_totals[0] << ", total words: " << global_totals[1] << std::endl;
+        if (all_written && build_index) std::cout << "Segment " << segment << " (" << path << ") added to index " << prefix << std::endl;
+        else if (all_written) std::cout << "Counts written to " << prefix << ".0 .. " << prefix << "." << numberOfProcesses - 1 << std::endl;
+        std::cout << "Time: " << slowest << " seconds" << std::endl;
+    }
+    return all_written ? 0 : 1;
+}
 
-void DoOutput(std::string word, int result)
+// Top-K words from fixed-size sketches: each rank fills a Count-Min sketch and a
+// Space-Saving summary from its words, and one MPI_Reduce merges them up a tree
+int TopK(const std::string& path, int k, const std::string& ingest, int processId)
 {
-    std::cout << "Word Frequency: " << word << " -> " << result << std::endl;
+    std::unique_ptr<WordSketch> local(new WordSketch), merged(new WordSketch);
+    SketchBuilder builder(*local);
+    double start_time = MPI_Wtime();
+    
+    if (ingest == "mmap") {
+        CorpusSlice slice;
+        if (!openCorpusSlice(path, MPI_COMM_WORLD, slice)) return 1;
+        forEachWord(slice.begin, slice.end, [&](const char* word, std::size_t length) { builder.add(word, length); });
+    } else if (ingest == "stream") {
+        bool streamed = streamWords(path, 0, MPI_COMM_WORLD, [&](const WordBatch& batch) {
+            for (std::uint32_t i = 0; i < batch.count; i++) builder.add(batch.word(i), batch.length(i));
+        });
+        if (!streamed) return 1;
+    } else {
+        if (processId == 0) std::cout << "ERROR: Unknown ingest mode " << ingest << ". Use mmap or stream." << std::endl;
+        return 0;
+    }
+    
+    double count_time = MPI_Wtime() - start_time;
+    reduceSketch(*local, *merged, 0, MPI_COMM_WORLD);
+    double elapsed = MPI_Wtime() - start_time, slowest[2] = {0.0, 0.0}, times[2] = {count_time, elapsed};
+    MPI_Reduce(times, slowest, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    
+    if (processId == 0) {
+        const double total = static_cast<double>(merged->total);
+        std::cout << "Top " << k << " of " << merged->total << " words (true count within [lower, upper]):" << std::endl;
+        for (const HeavyHitter& hitter : topWords(*merged, static_cast<std::size_t>(k))) {
+            std::cout << "  " << std::left << std::setw(24) << hitter.word << std::right
+                      << " [" << hitter.lower << ", " << hitter.upper << "]" << std::endl;
+        }
+        std::cout << "Space-Saving: every word occurring more than " << std::fixed << std::setprecision(1)
+                  << total / SKETCH_CAPACITY << " times is listed" << std::endl;
+        std::cout << "Count-Min: upper bounds exceed true counts by at most " << std::exp(1.0) * total / SKETCH_WIDTH
+                  << " with probability " << std::setprecision(3) << 1.0 - std::exp(-static_cast<double>(SKETCH_DEPTH)) << std::endl;
+        std::cout << std::defaultfloat << "Sketch: " << sizeof(WordSketch) << " bytes per rank" << std::endl;
+        std::cout << "Count: " << slowest[0] << " seconds, total: " << slowest[1] << " seconds" << std::endl;
+    }
+    return 0;
 }
 
-int countFrequency(std::vector<std::string>& data, const std::string& word)
+// Index lookups: rank 0 maps the one shard per segment that can hold each term and
+// binary-searches it; the corpus is not touched
+int Lookup(const std::string& prefix, const std::string& query, int processId)
 {
-    int freq = 0;
-    for (const auto& workString : data) {
-        if (workString == word)
-            freq++;
+    if (processId != 0) return 0;
+    std::vector<std::string> terms(1, query);
+    if (!query.empty() && query[0] == '@') {
+        terms.clear();
+        if (!loadQueryTerms(query.substr(1), terms)) return 1;
     }
-    return freq;
+    WordIndex index;
+    if (!index.open(prefix)) return 1;
+    
+    double start_time = MPI_Wtime();
+    std::vector<std::uint64_t> totals(terms.size());
+    std::vector<std::vector<std::uint64_t> > per_segment(terms.size());
+    for (std::size_t t = 0; t < terms.size(); t++) {
+        if (!index.lookup(terms[t], per_segment[t], totals[t])) return 1;
+    }
+    double elapsed = MPI_Wtime() - start_time;
+    
+    const std::vector<IndexSegment>& segments = index.segmentList();
+    for (std::size_t t = 0; t < terms.size(); t++) {
+        DoOutput(terms[t], static_cast<long long>(totals[t]));
+        for (std::size_t s = 0; s < segments.size() && segments.size() > 1; s++) {
+            if (per_segment[t][s] != 0) std::cout << "    " << segments[s].document << ": " << per_segment[t][s] << std::endl;
+        }
+    }
+    std::cout << "Lookup: " << elapsed * 1e6 / terms.size() << " microseconds per term" << std::endl;
+    return 0;
+}
+
+// Function for one read/distribute/count pass over the corpus. Fills local_counts
+// and this rank's seconds for the three phases in times[0..2]. With mmap every rank
+// reads its own slice, so nothing is distributed; when streaming, reading is the
+// root packing blocks, counting is time spent in the visitor, and distributing is
+// the rest (waiting on the scatters). `threads` OpenMP threads split each slice or
+// batch and merge their counts before anything leaves the rank, so the reduce
+// still sends one vector per rank.
+bool CountPass(const std::string& path, const std::string& word, const std::string& ingest, bool substrings,
+               const QueryAutomaton* automaton, int threads, std::vector<long long>& local_counts, double* times)
+{
+    std::fill(local_counts.begin(), local_counts.end(), 0);
+    std::vector<QueryHits> thread_hits(threads, QueryHits(automaton != nullptr ? automaton->nodes() : 0));
+    
+    if (ingest == "mmap") {
+        // Every rank maps the corpus and scans its own word-aligned byte range in place
+        double start = MPI_Wtime();
+        CorpusSlice slice;
+        if (!openCorpusSlice(path, MPI_COMM_WORLD, slice)) return false;
+        volatile unsigned long loaded = loadCorpusSlice(slice, threads);
+        (void)loaded;
+        times[0] = MPI_Wtime() - start;
+        times[1] = 0.0;
+        
+        start = MPI_Wtime();
+        long long matches = 0;
+        #pragma omp parallel for num_threads(threads) schedule(static) reduction(+ : matches)
+        for (int t = 0; t < threads; t++) {
+            const char *begin, *end;
+            splitCorpusRange(slice.begin, slice.end, threads, t, begin, end);
+            if (automaton != nullptr) scanText(*automaton, begin, end, substrings, thread_hits[t]);
+            else matches += countWordMatches(begin, end, word);
+        }
+        local_counts[0] += matches;
+        times[2] = MPI_Wtime() - start;
+    } else {
+        // Rank 0 streams bounded blocks of variable-length words; counting overlaps the next transfer
+        double start = MPI_Wtime(), reading = 0.0, counting = 0.0;
+        bool streamed = streamWords(path, 0, MPI_COMM_WORLD, [&](const WordBatch& batch) {
+            double visit_start = MPI_Wtime();
+            if (automaton == nullptr) {
+                local_counts[0] += countFrequency(batch, word, threads);
+            } else {
+                #pragma omp parallel num_threads(threads)
+                {
+                    QueryHits& hits = thread_hits[omp_get_thread_num()];
+                    #pragma omp for schedule(static)
+                    for (std::int64_t i = 0; i < static_cast<std::int64_t>(batch.count); i++)
+                        scanWord(*automaton, batch.word(i), batch.length(i), substrings, hits);
+                }
+            }
+            counting += MPI_Wtime() - visit_start;
+        }, &reading);
+        if (!streamed) return false;
+        times[0] = reading;
+        times[1] = MPI_Wtime() - start - reading - counting;
+        times[2] = counting;
+    }
+    
+    // Local reduction of the threads' hits
+    double merge_start = MPI_Wtime();
+    if (automaton != nullptr) {
+        for (int t = 1; t < threads; t++) mergeHits(thread_hits[0], thread_hits[t]);
+        termCounts(*automaton, thread_hits[0], local_counts.data());
+    }
+    times[2] += MPI_Wtime() - merge_start;
+    return true;
+}
+
+void PrintPhase(const std::string& name, PhaseTimer& timer, std::size_t phase)
+{
+    std::cout << std::left << std::setw(24) << name + ":" << std::right << std::setw(12) << PhaseTimer::median(timer.slowest[phase])
+              << " s slowest rank" << std::setw(12) << PhaseTimer::median(timer.fastest[phase]) << " s fastest rank" << std::endl;
+}
+
+// Word search with a timing harness: `iterations` full passes, each timing the read,
+// distribute, count and reduce phases on every rank from a common barrier. Each
+// phase is reported as the median over iterations of its slowest and fastest rank.
+// Reductions run on a copy of the counts, so `all` times every algorithm on the
+// same input and checks that they agree.
+int Search(const std::string& path, const std::string& word, const std::vector<ReduceAlgorithm>& algorithms,
+           const std::string& ingest, bool substrings, int iterations, int threads, int processId, int numberOfProcesses)
+{
+    // A query file, or substring matching, counts every term in one pass through an
+    // Aho-Corasick automaton built on rank 0; a single whole word uses the SIMD scan
+    bool multi = !word.empty() && word[0] == '@';
+    bool useAutomaton = multi || substrings;
+    std::vector<std::string> terms(1, word);
+    QueryAutomaton automaton;
+    if (useAutomaton) {
+        bool loaded = true;
+        if (processId == 0) {
+            if (multi) {
+                terms.clear();
+                loaded = loadQueryTerms(word.substr(1), terms);
+            }
+            if (loaded) automaton = buildQueryAutomaton(terms);
+        }
+        if (!broadcastQueryAutomaton(automaton, loaded, 0, MPI_COMM_WORLD)) return 1;
+    }
+    const int num_terms = useAutomaton ? static_cast<int>(automaton.terms()) : 1;
+    std::vector<long long> local_counts(num_terms, 0), global_counts, first_counts;
+    PhaseTimer timer;
+    bool agree = true;
+    
+    for (int it = 0; it < iterations; it++) {
+        std::vector<double> times(3 + algorithms.size());
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (!CountPass(path, word, ingest, substrings, useAutomaton ? &automaton : nullptr, threads, local_counts, times.data())) return 1;
+        
+        for (std::size_t a = 0; a < algorithms.size(); a++) {
+            global_counts = local_counts;
+            MPI_Barrier(MPI_COMM_WORLD);
+            double start_time = MPI_Wtime();
+            reduceCounts(algorithms[a], global_counts.data(), num_terms, 0, MPI_COMM_WORLD);
+            times[3 + a] = MPI_Wtime() - start_time;
+            if (processId == 0 && it == 0 && a == 0) first_counts = global_counts;
+            else if (processId == 0) agree &= global_counts == first_counts;
+        }
+        timer.record(times, MPI_COMM_WORLD);
+    }
+    
+    if (processId == 0) {
+        for (int t = 0; t < num_terms; t++) DoOutput(terms[t], first_counts[t]);
+        if (!agree) std::cout << "ERROR: Reduction algorithms disagree on the counts" << std::endl;
+        std::cout << "Median of " << iterations << " iteration(s), " << numberOfProcesses << " ranks x " << threads << " threads, "
+                  << num_terms * sizeof(long long) << " bytes reduced:" << std::endl;
+        PrintPhase("Read", timer, 0);
+        PrintPhase("Distribute", timer, 1);
+        PrintPhase("Count", timer, 2);
+        for (std::size_t a = 0; a < algorithms.size(); a++) PrintPhase(std::string("Reduce ") + reductionName(algorithms[a]), timer, 3 + a);
+    }
+    return agree ? 0 : 1;
+}
+
+// Function to resolve the thread count; 0 fills the cores this rank is bound to, or
+// its share of the node when it is not bound to fewer cores than the node has.
+// `requested` is the same on every rank, so with 0 all of them join the node split,
+// whatever their own binding.
+int HybridThreads(int requested)
+{
+    if (requested > 0) return requested;
+    NodeTopology topology = splitByNode(MPI_COMM_WORLD, 0);
+    const int available = omp_get_num_procs();
+    const int share = available < sysconf(_SC_NPROCESSORS_ONLN) ? available : std::max(1, available / topology.nodeSize);
+    freeNodeTopology(topology);
+    return share;
+}
+
+// Function to time every reduction algorithm on synthetic count vectors of growing
+// size, the payload of a full histogram rather than a single count, and to check
+// each result on the root
+int ReductionSweep(const std::vector<ReduceAlgorithm>& algorithms, int iterations, int processId, int numberOfProcesses)
+{
+    const int sizes[] = {1, 1 << 10, 1 << 16, 1 << 20};
+    const long long rank_sum = static_cast<long long>(numberOfProcesses) * (numberOfProcesses + 1) / 2;
+    bool correct = true;
+    if (processId == 0) {
+        std::cout << "Reduce time by payload (median of slowest rank, seconds):" << std::endl << std::setw(12) << "elements";
+        for (ReduceAlgorithm algorithm : algorithms) std::cout << std::setw(14) << reductionName(algorithm);
+        std::cout << std::endl;
+    }
+    for (int count : sizes) {
+        std::vector<long long> local(count), counts;
+        for (int i = 0; i < count; i++) local[i] = static_cast<long long>(processId + 1) * (i % 1000 + 1);
+        PhaseTimer timer;
+        for (int it = 0; it < iterations; it++) {
+            std::vector<double> times(algorithms.size());
+            for (std::size_t a = 0; a < algorithms.size(); a++) {
+                counts = local;
+                MPI_Barrier(MPI_COMM_WORLD);
+                double start_time = MPI_Wtime();
+                reduceCounts(algorithms[a], counts.data(), count, 0, MPI_COMM_WORLD);
+                times[a] = MPI_Wtime() - start_time;
+                for (int i = 0; i < count && processId == 0; i++) correct &= counts[i] == rank_sum * (i % 1000 + 1);
+            }
+            timer.record(times, MPI_COMM_WORLD);
+        }
+        if (processId == 0) {
+            std::cout << std::setw(12) << count;
+            for (std::size_t a = 0; a < algorithms.size(); a++) std::cout << std::setw(14) << PhaseTimer::median(timer.slowest[a]);
+            std::cout << std::endl;
+        }
+    }
+    if (processId == 0 && !correct) std::cout << "ERROR: A reduction algorithm produced wrong sums" << std::endl;
+    return correct ? 0 : 1;
 }
 
 int main(int argc, char* argv[])
 {
     int processId, numberOfProcesses;
     numberOfProcesses = 8;
-    double start_time, end_time;
     
-    MPI_Init(&argc, &argv);
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided); // OpenMP threads count inside each rank
     MPI_Comm_rank(MPI_COMM_WORLD, &processId);
     MPI_Comm_size(MPI_COMM_WORLD, &numberOfProcesses);
     
-    if (argc != 4)
+    if (argc < 4 || argc > 8)
     {
         if (processId == 0)
         {
-            std::cout << "ERROR: Incorrect number of arguments. Format is: <path to search file> <search word> <b1/b2>" << std::endl;
+            std::cout << "ERROR: Incorrect number of arguments. Format is: <path to search file> <search word | @query file> <b1/b2/binomial/doubling/rabenseifner/pipeline/ireduce/all> [mmap/stream] [word/substring] [iterations] [threads, 0 = fill the node]" << std::endl;
+            std::cout << "       or, for the whole frequency table: <path to search file> <output prefix> wordcount [mmap/stream]" << std::endl;
+            std::cout << "       or, to add a file to an index: <path to search file> <index prefix> index [mmap/stream]" << std::endl;
+            std::cout << "       or, to query an index: <index prefix> <search word | @query file> lookup" << std::endl;
+            std::cout << "       or, for the most frequent words: <path to search file> <k> topk [mmap/stream]" << std::endl;
         }
         MPI_Finalize();
         return 0;
     }
     
-    std::string word = argv[2];
-    Lines lines;
-    
-    int chunk_size = ARRAY_SIZE / numberOfProcesses;
-    char local_buf[chunk_size][16];
+    if (std::string(argv[3]) == "wordcount" || std::string(argv[3]) == "index") {
+        int status = WordCount(argv[1], argv[2], argc > 4 ? argv[4] : "mmap", std::string(argv[3]) == "index", processId, numberOfProcesses);
+        MPI_Finalize();
+        return status;
+    }
     
-    if (processId == 0) {
-        std::ifstream file;
-        file.imbue(std::locale(std::locale(), new letter_only()));
-        file.open(argv[1]);
-        std::string workString;
-        int i = 0;
-        while (file >> workString && i < ARRAY_SIZE) {
-            memset(lines[i], '\0', 16);
-            memcpy(lines[i++], workString.c_str(), workString.length());
+    if (std::string(argv[3]) == "topk") {
+        int k = std::atoi(argv[2]);
+        if (k < 1 || k > SKETCH_CAPACITY) {
+            if (processId == 0) std::cout << "ERROR: k must be between 1 and " << SKETCH_CAPACITY << std::endl;
+            MPI_Finalize();
+            return 0;
         }
+        int status = TopK(argv[1], k, argc > 4 ? argv[4] : "mmap", processId);
+        MPI_Finalize();
+        return status;
     }
     
-    MPI_Scatter(lines, chunk_size * 16, MPI_CHAR, local_buf, chunk_size * 16, MPI_CHAR, 0, MPI_COMM_WORLD);
-    
-    std::vector<std::string> local_data;
-    for (int i = 0; i < chunk_size; i++) {
-        local_data.emplace_back(local_buf[i]);
+    if (std::string(argv[3]) == "lookup") {
+        int status = Lookup(argv[1], argv[2], processId);
+        MPI_Finalize();
+        return status;
     }
     
-    int local_count = countFrequency(local_data, word);
-    int global_count = local_count;
-    
-    start_time = MPI_Wtime();
-    
-    std::string mode = argv[3];
-    if (mode == "b1") {
-        MPI_Reduce(&local_count, &global_count, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-    } else {
-        if (processId > 0) {
-            int received_count;
-            MPI_Recv(&received_count, 1, MPI_INT, processId - 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            global_count += received_count;
-        }
-        if (processId < numberOfProcesses - 1) {
-            MPI_Send(&global_count, 1, MPI_INT, processId + 1, 0, MPI_COMM_WORLD);
+    std::string word = argv[2];
+    std::string ingest = argc > 4 ? argv[4] : "mmap";
+    bool substrings = argc > 5 && std::string(argv[5]) == "substring";
+    int iterations = argc > 6 ? std::atoi(argv[6]) : 1;
+    int threads = argc > 7 ? std::atoi(argv[7]) : 1;
+    if (ingest != "mmap" && ingest != "stream") {
+        if (processId == 0)
+        {
+            std::cout << "ERROR: Unknown ingest mode " << ingest << ". Use mmap or stream." << std::endl;
         }
+        MPI_Finalize();
+        return 0;
     }
     
-    end_time = MPI_Wtime();
-    
-    if (processId == numberOfProcesses - 1 && mode == "b2") {
-        MPI_Send(&global_count, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-    }
-    
-    if (processId == 0) {
-        if (mode == "b2") {
-            MPI_Recv(&global_count, 1, MPI_INT, numberOfProcesses - 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    // b1 is MPI_Reduce and b2 the serialized ring, now timed up to its last hop into rank 0
+    std::vector<ReduceAlgorithm> algorithms;
+    ReduceAlgorithm algorithm;
+    if (std::string(argv[3]) == "all") {
+        for (const char* name : {"b1", "b2", "binomial", "doubling", "rabenseifner", "pipeline", "ireduce"}) {
+            parseReduction(name, algorithm);
+            algorithms.push_back(algorithm);
         }
-        DoOutput(word, global_count);
-        std::cout << "Time: " << (end_time - start_time) << " seconds" << std::endl;
+    } else if (parseReduction(argv[3], algorithm)) {
+        algorithms.push_back(algorithm);
+    }
+    if (algorithms.empty() || iterations < 1 || threads < 0) {
+        if (processId == 0) std::cout << "ERROR: Unknown reduction " << argv[3] << ", or iteration or thread count out of range" << std::endl;
+        MPI_Finalize();
+        return 0;
     }
     
+    // OpenMP threads inside a rank need at least funneled MPI; without it, count on the main thread only
+    if (provided < MPI_THREAD_FUNNELED && threads != 1) {
+        if (processId == 0) std::cout << "WARNING: MPI does not support MPI_THREAD_FUNNELED; counting with one thread per rank." << std::endl;
+        threads = 1;
+    }
+    int status = Search(argv[1], word, algorithms, ingest, substrings, iterations, HybridThreads(threads), processId, numberOfProcesses);
+    if (status == 0 && algorithms.size() > 1) status = ReductionSweep(algorithms, iterations, processId, numberOfProcesses);
     MPI_Finalize();
-    return 0;
+    return status;
 }
@@ -5,45 +5,21 @@
 #include <vector>
 #include <array>
 #include <sstream>
-#include <unordered_set>
-
-#define MAX_INTENSITY 256 // Grayscale intensity levels
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
+#include "histogram.h"
+#include "histogram_aggregation.h"
+#include "image_kernels.h"
+#include "image_service.h"
+#include "node_topology.h"
+#include "pgm_io.h"
+#include "pgm_mpiio.h"
+
+#define EQUALIZE_GRAIN (1 << 20) // Pixels remapped per OpenMP work item
+#define AGGREGATION_TRIALS 10    // Runs per backend in compare mode
 
 int rank, size; // MPI process ID and total processes
-// Read PGM Image
-std::vector<unsigned char> readPGM(const std::string &filename, int &width, int &height) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        if (rank == 0) std::cerr << "ERROR: Could not open file " << filename << std::endl;
-        return {};
-    }
-
-    std::string format;
-    file >> format;
-    if (format != "P2") {
-        if (rank == 0) std::cerr << "ERROR: Not a valid ASCII PGM (P2) image.\n";
-        return {};
-    }
-
-    // Skip comments
-    std::string line;
-    while (file.peek() == '#') std::getline(file, line);
-
-    // Read width, height, and max intensity
-    int maxShades;
-    file >> width >> height >> maxShades;
-
-    // Read pixel data
-    std::vector<unsigned char> image(width * height);
-    for (int i = 0; i < width * height; i++) {
-        int pixelVal;
-        file >> pixelVal;
-        image[i] = static_cast<unsigned char>(pixelVal);
-    }
-
-    return image;
-}
-
 // Read adjacency matrix from file
 std::vector<std::vector<int> > readAdjacencyMatrix(const std::string &filename, int &numNodes) {
     std::ifstream file(filename);
@@ -71,10 +47,7 @@ std::vector<std::vector<int> > readAdjacencyMatrix(const std::string &filename,
 // Compute local histogram [only worry about the amount of the image that must be computed]
 std::array<int, MAX_INTENSITY> computeLocalHistogram(const std::vector<unsigned char> &image) {
     std::array<int, MAX_INTENSITY> localHistogram;
-    localHistogram.fill(0);
-    for (int i = 0; i < (int)image.size(); i++) {
-        localHistogram[image[i]]++;
-    }
+    computeHistogram(image.data(), image.size(), localHistogram);
     return localHistogram;
 }
 
@@ -90,128 +63,236 @@ void writeHistogramToFile(const std::string &filename, const std::array<int, MAX
     }
 }
 
+// Equalize the whole image with nothing funnelled through one rank: the
+// local histograms are summed with MPI_Allreduce, every rank builds the same
+// LUT, remaps its own slab in place and writes it with collective MPI-IO
+bool equalizeDistributed(const std::string &filename, const PGMHeader &header,
+                         std::vector<unsigned char> &localChunk, std::size_t chunkOffset) {
+    std::array<int, MAX_INTENSITY> localHistogram = computeLocalHistogram(localChunk), globalHistogram;
+    MPI_Allreduce(localHistogram.data(), globalHistogram.data(), MAX_INTENSITY, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    const std::size_t pixelCount = static_cast<std::size_t>(header.width) * header.height;
+    const std::array<unsigned char, MAX_INTENSITY> lut = buildEqualizationLUT(globalHistogram, pixelCount);
+    const long long pieces = static_cast<long long>((localChunk.size() + EQUALIZE_GRAIN - 1) / EQUALIZE_GRAIN);
+    #pragma omp parallel for schedule(static)
+    for (long long p = 0; p < pieces; p++) {
+        std::size_t begin = static_cast<std::size_t>(p) * EQUALIZE_GRAIN;
+        std::size_t count = std::min<std::size_t>(EQUALIZE_GRAIN, localChunk.size() - begin);
+        applyLUT(localChunk.data() + begin, localChunk.data() + begin, count, lut);
+    }
+
+    return writePGMSlab(filename, MPI_COMM_WORLD, header.width, header.height, localChunk.data(), localChunk.size(), chunkOffset);
+}
+
+// Histogram the image with one copy per node: node leaders read their node's
+// slab into a shared window, every rank histograms its part of it in place,
+// and only the per-node totals cross between nodes
+bool histogramShared(const std::string &input, const std::string &output, int initiatorNode) {
+    double start_time = MPI_Wtime();
+    NodeTopology topology = splitByNode(MPI_COMM_WORLD, initiatorNode);
+    PGMHeader header;
+    SharedImageSlab slab;
+    if (!loadSharedSlab(input, initiatorNode, MPI_COMM_WORLD, topology, header, slab)) {
+        freeNodeTopology(topology);
+        return false;
+    }
+    double load_time = MPI_Wtime();
+
+    std::size_t offset, length;
+    slabRange(slab.length, topology.nodeSize, topology.nodeRank, offset, length);
+    std::array<int, MAX_INTENSITY> localHistogram, nodeHistogram, histogram;
+    computeHistogram(slab.pixels + offset, length, localHistogram);
+
+    MPI_Reduce(localHistogram.data(), nodeHistogram.data(), MAX_INTENSITY, MPI_INT, MPI_SUM, 0, topology.nodeComm);
+    if (topology.leaderComm != MPI_COMM_NULL) {
+        MPI_Reduce(nodeHistogram.data(), histogram.data(), MAX_INTENSITY, MPI_INT, MPI_SUM, 0, topology.leaderComm);
+    }
+    double end_time = MPI_Wtime();
+
+    MPI_Win_free(&slab.window);
+    if (rank == initiatorNode) {
+        writeHistogramToFile(output, histogram);
+        std::cout << "Final histogram saved to " << output << " (" << topology.numNodes << " node(s), load "
+                  << (load_time - start_time) * 1000.0 << " ms, count and aggregation "
+                  << (end_time - load_time) * 1000.0 << " ms).\n";
+    }
+    freeNodeTopology(topology);
+    return true;
+}
+
+// Count the local slab and aggregate it onto the initiator with `backend`.
+// `handoff` is when this rank's counts left its hands (it is free to move on);
+// `latency` is when the total was complete on the initiator.
+void countAndAggregate(AggregationBackend backend, const SpanningTree &tree, const std::vector<unsigned char> &localChunk,
+                       int initiatorNode, std::array<int, MAX_INTENSITY> &histogram, double &handoff, double &latency) {
+    std::unique_ptr<HistogramWindow> window;
+    if (backend == AggregationBackend::RMA) window.reset(new HistogramWindow(initiatorNode, MPI_COMM_WORLD));
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    double start_time = MPI_Wtime();
+    histogram = computeLocalHistogram(localChunk);
+    switch (backend) {
+        case AggregationBackend::Tree: convergecastHistogram(tree, histogram, MPI_COMM_WORLD); break;
+        case AggregationBackend::Reduce: reduceHistogram(histogram, initiatorNode, MPI_COMM_WORLD); break;
+        case AggregationBackend::RMA: window->push(histogram); break;
+    }
+    handoff = MPI_Wtime() - start_time;
+    if (window) window->finish(histogram);
+    latency = MPI_Wtime() - start_time;
+}
+
+// Run every backend AGGREGATION_TRIALS times and report median initiator
+// latency and median mean hand-off time, checking the totals agree
+bool compareBackends(const SpanningTree &tree, const std::vector<unsigned char> &localChunk, int initiatorNode) {
+    const AggregationBackend backends[] = {AggregationBackend::Tree, AggregationBackend::Reduce, AggregationBackend::RMA};
+    std::array<int, MAX_INTENSITY> expected{}, histogram;
+    bool agree = true;
+    for (AggregationBackend backend : backends) {
+        std::vector<double> latencies, handoffs;
+        for (int trial = 0; trial < AGGREGATION_TRIALS; trial++) {
+            double handoff, latency, handoffSum = 0.0;
+            countAndAggregate(backend, tree, localChunk, initiatorNode, histogram, handoff, latency);
+            MPI_Reduce(&handoff, &handoffSum, 1, MPI_DOUBLE, MPI_SUM, initiatorNode, MPI_COMM_WORLD);
+            latencies.push_back(latency);
+            handoffs.push_back(handoffSum / size);
+        }
+        if (rank != initiatorNode) continue;
+        if (backend == AggregationBackend::Tree) expected = histogram;
+        agree &= histogram == expected;
+        std::sort(latencies.begin(), latencies.end());
+        std::sort(handoffs.begin(), handoffs.end());
+        std::cout << aggregationName(backend) << ": total ready after " << latencies[latencies.size() / 2] * 1000.0
+                  << " ms, ranks released after " << handoffs[handoffs.size() / 2] * 1000.0 << " ms (median of "
+                  << AGGREGATION_TRIALS << ")" << (histogram == expected ? "" : "  MISMATCH") << "\n";
+    }
+    MPI_Bcast(&agree, 1, MPI_CXX_BOOL, initiatorNode, MPI_COMM_WORLD);
+    return agree;
+}
+
 int errorCorrection(int argc, char *argv[]) {
-    if (argc != 4) {
-        // if (rank == 0) 
-        std::cerr << "Usage: " << argv[0] << " <input_pgm> <adjacency_matrix> <output_file>\n";
+    if (argc < 4 || argc > 6) {
+        if (rank == 0) std::cerr << "Usage: " << argv[0] << " <input_pgm> <adjacency_matrix> <output_file> [root_rank] [tree|reduce|rma|compare|equalize|shared]\n"
+                                << "       " << argv[0] << " <job_fifo|spool_dir|job_list> - <report_file> [root_rank] serve\n";
+        MPI_Finalize();
+        return -1;
+    }
+
+    const std::string mode = argc > 5 ? argv[5] : "tree";
+    AggregationBackend backend;
+    if (!parseAggregationBackend(mode, backend) && mode != "compare" && mode != "equalize" && mode != "shared" && mode != "serve") {
+        if (rank == 0) std::cerr << "ERROR: Unknown mode '" << argv[5] << "'.\n";
         MPI_Finalize();
         return -1;
     }
 
     if (size <= 1) {
-        // if (rank == 0) 
-        std::cerr << "ERROR: Need at least two processes.\n";
+        if (rank == 0) std::cerr << "ERROR: Need at least two processes.\n";
         MPI_Finalize();
         return -1;
     }
     return 0;
 }
 
-void tarryAlgorithm(int node, const std::vector<std::vector<int>> &adjMatrix, 
-                    std::unordered_set<int> &visited, 
-                    std::array<int, MAX_INTENSITY> &localHist) {
-    visited.insert(node);
-    if (visited.size() == 4) {
-        std::cout << "All nodes have been visited." << std::endl;
-        return;
+
+int alt_main(int argc, char *argv[]) {
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided); // Service mode reads jobs on a helper thread
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0) std::cerr << "ERROR: MPI does not support MPI_THREAD_FUNNELED, which the service reader thread and OpenMP kernels need.\n";
+        MPI_Finalize();
+        return -1;
     }
-    MPI_Barrier(MPI_COMM_WORLD);
+    if (errorCorrection(argc, argv) != 0) return -1; // ** ERROR DETECTION
 
-    // Process each neighbor
-    for (size_t neighbor = 0; neighbor < adjMatrix[node].size(); ++neighbor) {
-        if (adjMatrix[node][neighbor] == 1 && visited.find(neighbor) == visited.end()) {
-
-            // Send and receive local histogram from neighbor using MPI_Sendrecv (non-blocking type)
-            std::array<int, MAX_INTENSITY> receivedHist;
-            MPI_Sendrecv(localHist.data(), MAX_INTENSITY, MPI_INT, neighbor, node,
-                         receivedHist.data(), MAX_INTENSITY, MPI_INT, neighbor, node,
-                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-            // Merge histograms
-            for (int i = 0; i < MAX_INTENSITY; i++) {
-                localHist[i] += receivedHist[i];
-            }
-            // Recursively perform DFS (or Tarry's traversal) on the neighbor
-            tarryAlgorithm(neighbor, adjMatrix, visited, localHist);
-            MPI_Barrier(MPI_COMM_WORLD);
+    int numNodes = 0;
+    const std::string mode = argc > 5 ? argv[5] : "tree";
+    int initiatorNode = argc > 4 ? std::atoi(argv[4]) : 0;
+    if (initiatorNode < 0 || initiatorNode >= size) {
+        if (rank == 0) std::cerr << "ERROR: Root rank must be between 0 and " << size - 1 << ".\n";
+        MPI_Finalize();
+        return -1;
+    }
+
+    // Service mode: ranks stay up and the root hands out jobs until a "stop" line
+    if (mode == "serve") {
+        if (rank == initiatorNode) {
+            std::vector<ServiceJob> jobs = serviceMaster(argv[1], initiatorNode, MPI_COMM_WORLD);
+            reportService(jobs, argv[3]);
+        } else {
+            serviceWorker(initiatorNode, MPI_COMM_WORLD);
         }
+        MPI_Finalize();
+        return 0;
     }
-    return;
-}
 
+    // Node-aware mode shares one copy of the image per node instead of one slab per rank
+    if (mode == "shared") {
+        bool ok = histogramShared(argv[1], argv[3], initiatorNode);
+        MPI_Finalize();
+        return ok ? 0 : -1;
+    }
 
-int alt_main(int argc, char *argv[]) {
-    MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
-    errorCorrection(argc, argv); // ** ERROR DETECTION
+    // Every rank reads its own slab of the image; only the header is broadcast
+    PGMHeader header;
+    std::vector<unsigned char> localChunk;
+    std::size_t chunkOffset = 0;
+    if (!readPGMSlab(argv[1], initiatorNode, MPI_COMM_WORLD, header, localChunk, chunkOffset)) {
+        MPI_Finalize();
+        return -1;
+    }
 
-    int width, height, numNodes;
-    numNodes = 4;
-    int initiatorNode = 3;
-    int chunk_size = width * height / size;
+    // Equalization mode writes the transformed image instead of the histogram
+    if (mode == "equalize") {
+        double start_time = MPI_Wtime();
+        bool written = equalizeDistributed(argv[3], header, localChunk, chunkOffset);
+        double elapsed = MPI_Wtime() - start_time, slowest = 0.0;
+        MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, initiatorNode, MPI_COMM_WORLD);
+        if (rank == initiatorNode && written) {
+            std::cout << "Equalized image saved to " << argv[3] << " (" << slowest * 1000.0 << " ms).\n";
+        }
+        MPI_Finalize();
+        return written ? 0 : -1;
+    }
 
-    std::vector<unsigned char> image;
     std::vector<std::vector<int> > adjacencyMatrix;
+    int topologyOk = 1;
     if (rank == initiatorNode) {
-        image = readPGM(argv[1], width, height); // processed images correctly
         adjacencyMatrix = readAdjacencyMatrix(argv[2], numNodes); // read and constructed adjacency matrix correctly
-        if (image.empty() || adjacencyMatrix.empty()) { MPI_Finalize(); return -1; }
-        chunk_size = width * height / size;
-    }MPI_Bcast(&chunk_size, 1, MPI_INT, 3, MPI_COMM_WORLD);
-    std::cout << "B-Casted chunk size to all nodes" << std::endl;
-    std::cout << "Chunk size: " << chunk_size << " For rank: " << rank << std::endl;
-
-    std::vector<unsigned char> localChunk(chunk_size);
-    std::fill(localChunk.begin(), localChunk.end(), 0);
-    MPI_Scatter(image.data(), chunk_size, MPI_UNSIGNED_CHAR, localChunk.data(), chunk_size, MPI_UNSIGNED_CHAR, 3, MPI_COMM_WORLD);
-    std::cout << "Node " << rank << " received data of chunk size " << chunk_size << std::endl;
-
-    std::array<int, MAX_INTENSITY> localHistogram = computeLocalHistogram(localChunk);
-    std::cout << "Computed @ node " << rank << ". Histogram successfully computed. " << std::endl;
-
-
-    std::array<int, MAX_INTENSITY> globalHistogram;
-    globalHistogram.fill(0);
-
-    std::unordered_set<int> visited;
-    bool isFinished;
-    int root = (size > 4) ? 3 : 0;
-    if (rank == root) {
-        // MPI_Bcast(&visited, 1, MPI_INT, rank, MPI_COMM_WORLD);
-        std::cout << "Tarry algorithm started @ node: " << rank << std::endl;
-        tarryAlgorithm(rank, adjacencyMatrix, visited, localHistogram);
-        isFinished = true;
-        std::cout << "FINISHED FLAG" << std::endl;
-    } MPI_Bcast(&isFinished, 1, MPI_CXX_BOOL, rank, MPI_COMM_WORLD);
-
-
-    MPI_Reduce(localHistogram.data(), globalHistogram.data(), 256, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-
-    if (rank == 3) {
-        std::cout << "Writing histogram" << std::endl;
-        writeHistogramToFile(argv[3], localHistogram);
-        std::cout << "Final histogram saved to " << argv[3] << ".\n";
-        // isFinished = true;
-        // MPI_Finalize();   
+        topologyOk = !adjacencyMatrix.empty();
+    }
+    MPI_Bcast(&topologyOk, 1, MPI_INT, initiatorNode, MPI_COMM_WORLD);
+    if (!topologyOk) { MPI_Finalize(); return -1; }
+
+    // Every rank derives the same spanning tree from the shared topology
+    broadcastAdjacencyMatrix(adjacencyMatrix, initiatorNode, rank, MPI_COMM_WORLD);
+    SpanningTree tree = buildSpanningTree(adjacencyMatrix, initiatorNode, rank, size);
+
+    if (mode == "compare") {
+        bool agree = compareBackends(tree, localChunk, initiatorNode);
+        MPI_Finalize();
+        return agree ? 0 : -1;
+    }
+
+    AggregationBackend backend = AggregationBackend::Tree;
+    parseAggregationBackend(mode, backend);
+    std::array<int, MAX_INTENSITY> histogram;
+    double handoff, latency;
+    countAndAggregate(backend, tree, localChunk, initiatorNode, histogram, handoff, latency);
+
+    if (rank == initiatorNode) {
+        writeHistogramToFile(argv[3], histogram);
+        std::cout << "Final histogram saved to " << argv[3] << " (" << aggregationName(backend) << " aggregation, tree height "
+                  << tree.height << ", count and aggregation time " << latency * 1000.0 << " ms).\n";
     }
-    // MPI_Barrier(MPI_COMM_WORLD);
-    // MPI_Finalize();
-    // std::cout << "@ node " << rank << " is still running" << std::endl;
-    // if (isFinished == true) {
-    //     MPI_Finalize();
-    //     // std::exit(0);
-    // }
     MPI_Finalize();
-    return 1;
+    return 0;
 }
 
 
 int main(int argc, char* argv[]) {
-    alt_main(argc, argv);
-    MPI_Finalize();
-    std::exit(0);
-    return 1;
+    return alt_main(argc, argv) == 0 ? 0 : 1;
 }
 // int main(int argc, char *argv[]) {
 //     MPI_Init(&argc, &argv);
@@ -0,0 +1,100 @@
+#include <mpi.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "distributed_stencil.h"
+#include "pgm_io.h"
+#include "pgm_mpiio.h"
+
+int rank, size; // MPI process ID and total processes
+
+// Function to map the pass name from the command line to a kernel
+bool parsePass(const std::string &name, StencilKernel &kernel, bool &iterate) {
+    iterate = name == "smooth";
+    if (name == "gaussian" || name == "smooth") kernel = StencilKernel::Gaussian;
+    else if (name == "sobel") kernel = StencilKernel::Sobel;
+    else if (name == "box") kernel = StencilKernel::Box;
+    else return false;
+    return true;
+}
+
+int errorCorrection(int argc, char *argv[]) {
+    if (argc < 4 || argc > 6) {
+        if (rank == 0) std::cerr << "Usage: " << argv[0] << " <input_pgm> <output_pgm> <gaussian|sobel|box|smooth> [iterations] [box_radius]\n";
+        MPI_Finalize();
+        return -1;
+    }
+    StencilKernel kernel;
+    bool iterate;
+    if (!parsePass(argv[3], kernel, iterate)) {
+        if (rank == 0) std::cerr << "ERROR: Unknown pass '" << argv[3] << "'.\n";
+        MPI_Finalize();
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (errorCorrection(argc, argv) != 0) return 1; // ** ERROR DETECTION
+
+    StencilKernel kernel;
+    bool iterate;
+    parsePass(argv[3], kernel, iterate);
+    // Gaussian, Sobel and box are single passes unless iterations are given; smooth defaults to 4
+    const int iterations = std::max(1, argc > 4 ? std::atoi(argv[4]) : (iterate ? 4 : 1));
+    // Clamped once here, as boxFilter does, so the halo and the kernel agree on it
+    const int boxRadius = std::min(std::max(argc > 5 ? std::atoi(argv[5]) : 2, 0), MAX_BOX_RADIUS);
+    const int halo = stencilRadius(kernel, boxRadius);
+
+    PGMHeader header;
+    if (!broadcastPGMHeader(argv[1], 0, MPI_COMM_WORLD, header)) {
+        MPI_Finalize();
+        return 1;
+    }
+    BlockDecomposition grid;
+    if (!decomposeImage(header.width, header.height, halo, MPI_COMM_WORLD, grid)) {
+        if (rank == 0) std::cerr << "ERROR: Image is too small to give every rank a block of at least " << halo << " pixels.\n";
+        MPI_Finalize();
+        return 1;
+    }
+    int gridRank;
+    MPI_Comm_rank(grid.cart, &gridRank);
+
+    std::vector<unsigned char> current(grid.paddedSize()), next(grid.paddedSize());
+    double readStart = MPI_Wtime();
+    if (!readPGMBlock(argv[1], grid.cart, header, grid.rowBegin, grid.colBegin, grid.rows, grid.cols, halo, current.data())) {
+        freeDecomposition(grid);
+        MPI_Finalize();
+        return 1;
+    }
+    double readEnd = MPI_Wtime();
+
+    MPI_Barrier(grid.cart);
+    double computeStart = MPI_Wtime();
+    for (int i = 0; i < iterations; i++) {
+        runStencilPass(grid, kernel, boxRadius, current.data(), next.data());
+        current.swap(next);
+    }
+    double computeEnd = MPI_Wtime();
+
+    bool written = writePGMBlock(argv[2], grid.cart, header.width, header.height, grid.rowBegin, grid.colBegin,
+                                 grid.rows, grid.cols, halo, current.data());
+    double writeEnd = MPI_Wtime();
+
+    // The slowest rank sets the pace of every phase
+    double phases[3] = {readEnd - readStart, computeEnd - computeStart, writeEnd - computeEnd}, slowest[3];
+    MPI_Reduce(phases, slowest, 3, MPI_DOUBLE, MPI_MAX, 0, grid.cart);
+    if (gridRank == 0 && written) {
+        std::cout << "Wrote " << argv[2] << " (" << header.width << "x" << header.height << ", "
+                  << grid.dims[0] << "x" << grid.dims[1] << " grid, " << iterations << " pass(es)).\n"
+                  << "Read " << slowest[0] * 1000.0 << " ms, stencil " << slowest[1] * 1000.0
+                  << " ms, write " << slowest[2] * 1000.0 << " ms.\n";
+    }
+    freeDecomposition(grid);
+    MPI_Finalize();
+    return written ? 0 : 1;
+}
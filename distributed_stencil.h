@@ -0,0 +1,221 @@
+#ifndef DISTRIBUTED_STENCIL_H
+#define DISTRIBUTED_STENCIL_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "image_kernels.h"
+#include "loop_scheduler.h"
+#include "pgm_mpiio.h"
+
+#define STENCIL_BAND_ROWS 256 // Interior rows computed between polls of the halo requests
+
+// The image is cut into a 2D grid of blocks, one per rank. Each rank keeps its
+// block in a buffer padded by `halo` pixels on every side; the padding holds
+// copies of the neighbours' edge pixels (or replicated image borders), so the
+// tile kernels from image_kernels.h run on the padded buffer unchanged.
+
+enum class StencilKernel { Gaussian, Sobel, Box };
+
+struct BlockDecomposition {
+    MPI_Comm cart = MPI_COMM_NULL;
+    int dims[2] = {0, 0};       // Grid rows, grid columns
+    int coords[2] = {0, 0};     // This rank's grid row and column
+    int width = 0, height = 0;  // Whole image
+    int rowBegin = 0, rows = 0; // This rank's block
+    int colBegin = 0, cols = 0;
+    int halo = 0;
+    int neighbors[3][3];        // Rank at grid offset (dy + 1, dx + 1); MPI_PROC_NULL off the grid
+    MPI_Datatype sendTypes[3][3];
+    MPI_Datatype recvTypes[3][3];
+
+    int stride() const { return cols + 2 * halo; }
+    int paddedRows() const { return rows + 2 * halo; }
+    std::size_t paddedSize() const { return static_cast<std::size_t>(paddedRows()) * stride(); }
+};
+
+// Function to return the halo a kernel needs on each side; `boxRadius` must
+// already be clamped to [0, MAX_BOX_RADIUS]
+inline int stencilRadius(StencilKernel kernel, int boxRadius) {
+    switch (kernel) {
+        case StencilKernel::Gaussian: return 2;
+        case StencilKernel::Sobel: return 1;
+        case StencilKernel::Box: return std::max(1, boxRadius);
+    }
+    return 1;
+}
+
+// Function to lay a near-square grid of blocks over the image and describe
+// this rank's block. Blocks are at least `halo` pixels on each side so every
+// halo comes from a direct neighbour; returns false on every rank otherwise.
+inline bool decomposeImage(int width, int height, int halo, MPI_Comm comm, BlockDecomposition &grid) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    grid.dims[0] = grid.dims[1] = 0;
+    MPI_Dims_create(size, 2, grid.dims);
+    // MPI_Dims_create orders dims non-increasingly; give the larger count to the longer side
+    if ((width > height) != (grid.dims[1] > grid.dims[0])) std::swap(grid.dims[0], grid.dims[1]);
+
+    int periods[2] = {0, 0};
+    MPI_Cart_create(comm, 2, grid.dims, periods, 1, &grid.cart);
+    int rank;
+    MPI_Comm_rank(grid.cart, &rank);
+    MPI_Cart_coords(grid.cart, rank, 2, grid.coords);
+
+    std::size_t offset, length;
+    slabRange(static_cast<std::size_t>(height), grid.dims[0], grid.coords[0], offset, length);
+    grid.rowBegin = static_cast<int>(offset);
+    grid.rows = static_cast<int>(length);
+    slabRange(static_cast<std::size_t>(width), grid.dims[1], grid.coords[1], offset, length);
+    grid.colBegin = static_cast<int>(offset);
+    grid.cols = static_cast<int>(length);
+    grid.width = width;
+    grid.height = height;
+    grid.halo = halo;
+
+    int ok = grid.rows >= halo && grid.cols >= halo, allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, grid.cart);
+    if (!allOk) {
+        MPI_Comm_free(&grid.cart);
+        return false;
+    }
+
+    // Region of the padded buffer along one axis: what goes to / comes from the neighbour at offset d
+    auto sendSpan = [&](int d, int n, int &start, int &count) {
+        start = d < 0 ? halo : d > 0 ? n : halo;
+        count = d == 0 ? n : halo;
+    };
+    auto recvSpan = [&](int d, int n, int &start, int &count) {
+        start = d < 0 ? 0 : d > 0 ? halo + n : halo;
+        count = d == 0 ? n : halo;
+    };
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            MPI_Datatype &sendType = grid.sendTypes[dy + 1][dx + 1];
+            MPI_Datatype &recvType = grid.recvTypes[dy + 1][dx + 1];
+            sendType = recvType = MPI_DATATYPE_NULL;
+            int &neighbor = grid.neighbors[dy + 1][dx + 1];
+            int target[2] = {grid.coords[0] + dy, grid.coords[1] + dx};
+            bool inside = target[0] >= 0 && target[0] < grid.dims[0] && target[1] >= 0 && target[1] < grid.dims[1];
+            neighbor = MPI_PROC_NULL;
+            if (dy == 0 && dx == 0) continue;
+            if (inside) MPI_Cart_rank(grid.cart, target, &neighbor);
+
+            int rowStart, rowCount, colStart, colCount;
+            sendSpan(dy, grid.rows, rowStart, rowCount);
+            sendSpan(dx, grid.cols, colStart, colCount);
+            sendType = byteSubarray(grid.paddedRows(), grid.stride(), rowCount, colCount, rowStart, colStart);
+            recvSpan(dy, grid.rows, rowStart, rowCount);
+            recvSpan(dx, grid.cols, colStart, colCount);
+            recvType = byteSubarray(grid.paddedRows(), grid.stride(), rowCount, colCount, rowStart, colStart);
+        }
+    }
+    return true;
+}
+
+inline void freeDecomposition(BlockDecomposition &grid) {
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (grid.sendTypes[i][j] != MPI_DATATYPE_NULL) MPI_Type_free(&grid.sendTypes[i][j]);
+            if (grid.recvTypes[i][j] != MPI_DATATYPE_NULL) MPI_Type_free(&grid.recvTypes[i][j]);
+        }
+    }
+    if (grid.cart != MPI_COMM_NULL) MPI_Comm_free(&grid.cart);
+}
+
+// Function to post the halo exchange with all eight neighbours. Diagonal
+// neighbours are included so corners arrive in the same round. The message
+// sent towards offset (dy, dx) is tagged with that direction; the receiver
+// expects it from the opposite side.
+inline void startHaloExchange(const BlockDecomposition &grid, unsigned char *buffer, std::vector<MPI_Request> &requests) {
+    requests.clear();
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int neighbor = grid.neighbors[dy + 1][dx + 1];
+            if ((dy == 0 && dx == 0) || neighbor == MPI_PROC_NULL) continue;
+            MPI_Request request;
+            MPI_Irecv(buffer, 1, grid.recvTypes[dy + 1][dx + 1], neighbor, (1 - dy) * 3 + (1 - dx), grid.cart, &request);
+            requests.push_back(request);
+            MPI_Isend(buffer, 1, grid.sendTypes[dy + 1][dx + 1], neighbor, (dy + 1) * 3 + (dx + 1), grid.cart, &request);
+            requests.push_back(request);
+        }
+    }
+}
+
+// Function to fill the halo on sides that lie on the image border by
+// replicating the edge pixels. Top/bottom first across the full padded width,
+// then left/right across the full padded height, so corners pick up the
+// right value whether they came from a neighbour or from the border.
+inline void fillBorderHalos(const BlockDecomposition &grid, unsigned char *buffer) {
+    const int h = grid.halo, stride = grid.stride();
+    auto row = [&](int r) { return buffer + static_cast<std::size_t>(r) * stride; };
+    if (grid.neighbors[0][1] == MPI_PROC_NULL) {
+        for (int r = 0; r < h; r++) std::memcpy(row(r), row(h), stride);
+    }
+    if (grid.neighbors[2][1] == MPI_PROC_NULL) {
+        for (int r = h + grid.rows; r < grid.paddedRows(); r++) std::memcpy(row(r), row(h + grid.rows - 1), stride);
+    }
+    const bool west = grid.neighbors[1][0] == MPI_PROC_NULL;
+    const bool east = grid.neighbors[1][2] == MPI_PROC_NULL;
+    if (!west && !east) return;
+    for (int r = 0; r < grid.paddedRows(); r++) {
+        unsigned char *line = row(r);
+        if (west) std::memset(line, line[h], h);
+        if (east) std::memset(line + h + grid.cols, line[h + grid.cols - 1], h);
+    }
+}
+
+// Function to run one kernel over a region of the padded buffer, in padded coordinates
+inline void applyStencilRegion(const BlockDecomposition &grid, StencilKernel kernel, int boxRadius,
+                               const unsigned char *src, unsigned char *dst, const LoopChunk &region) {
+    const int regionRows = region.rowEnd - region.rowBegin;
+    const int regionCols = region.colEnd - region.colBegin;
+    if (regionRows <= 0 || regionCols <= 0) return;
+    const int stride = grid.stride(), padded = grid.paddedRows();
+    SchedulerConfig config = resolveConfig(kernelTiles(), regionCols, regionRows);
+    runSchedule(config, regionCols, regionRows, [&](int, const LoopChunk &chunk) {
+        LoopChunk tile{region.rowBegin + chunk.rowBegin, region.rowBegin + chunk.rowEnd,
+                       region.colBegin + chunk.colBegin, region.colBegin + chunk.colEnd};
+        switch (kernel) {
+            case StencilKernel::Gaussian: gaussianTile(src, dst, stride, padded, tile); break;
+            case StencilKernel::Sobel: sobelTile(src, dst, stride, padded, tile); break;
+            case StencilKernel::Box: boxTile(src, dst, stride, padded, boxRadius, tile); break;
+        }
+    });
+}
+
+// Function to apply one stencil pass from `src` to `dst` (both padded
+// buffers). The halo exchange is posted first; the interior, whose inputs
+// are all local, is computed in bands while the halos are in flight, polling
+// the requests between bands so MPI can progress without a helper thread.
+// The rim of width `halo` is computed once the exchange completes.
+inline void runStencilPass(const BlockDecomposition &grid, StencilKernel kernel, int boxRadius,
+                           unsigned char *src, unsigned char *dst) {
+    const int h = grid.halo;
+    std::vector<MPI_Request> requests;
+    startHaloExchange(grid, src, requests);
+
+    const int innerBegin = 2 * h, innerEnd = grid.rows;    // Rows whose stencil stays inside the block
+    const int innerLeft = 2 * h, innerRight = grid.cols;
+    int flag = 0;
+    for (int band = innerBegin; band < innerEnd; band += STENCIL_BAND_ROWS) {
+        applyStencilRegion(grid, kernel, boxRadius, src, dst,
+                           LoopChunk{band, std::min(innerEnd, band + STENCIL_BAND_ROWS), innerLeft, innerRight});
+        if (!flag) MPI_Testall(static_cast<int>(requests.size()), requests.data(), &flag, MPI_STATUSES_IGNORE);
+    }
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+    fillBorderHalos(grid, src);
+
+    const int top = std::min(2 * h, h + grid.rows);
+    const int bottom = std::max(2 * h, grid.rows);
+    const int left = std::min(2 * h, h + grid.cols);
+    const int right = std::max(2 * h, grid.cols);
+    applyStencilRegion(grid, kernel, boxRadius, src, dst, LoopChunk{h, top, h, h + grid.cols});
+    applyStencilRegion(grid, kernel, boxRadius, src, dst, LoopChunk{bottom, h + grid.rows, h, h + grid.cols});
+    applyStencilRegion(grid, kernel, boxRadius, src, dst, LoopChunk{top, bottom, h, left});
+    applyStencilRegion(grid, kernel, boxRadius, src, dst, LoopChunk{top, bottom, right, h + grid.cols});
+}
+
+#endif // DISTRIBUTED_STENCIL_H
@@ -0,0 +1,120 @@
+#include <mpi.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bfs.h"
+#include "csr_graph.h"
+#include "distributed_bfs.h"
+#include "rmat_generator.h"
+
+#define BFS_ROOTS 16      // Search keys per run, as in Graph500 (which uses 64)
+#define BFS_ROOT_SEED 2   // Seed for choosing search keys
+#define RMAT_SEED 1
+
+int rank, size; // MPI process ID and total processes
+
+// Function to build this rank's part of the graph from "rmat:SCALE[:EDGE_FACTOR]",
+// a binary .csr file or an edge-list file
+bool loadGraph(const std::string &spec, DistributedGraph &graph) {
+    int scale, edgeFactor;
+    if (parseRMATSpec(spec, scale, edgeFactor)) {
+        generateDistributedRMAT(scale, edgeFactor, RMAT_SEED, MPI_COMM_WORLD, graph);
+        return true;
+    }
+    if (spec.size() > 4 && spec.compare(spec.size() - 4, 4, ".csr") == 0) {
+        return openDistributedBinary(spec, MPI_COMM_WORLD, graph);
+    }
+    return loadDistributedEdgeList(spec, MPI_COMM_WORLD, graph);
+}
+
+// Function to pick a random vertex with at least one edge; rank 0 proposes,
+// the owner answers with the degree. Callers must first check the graph has edges
+vertex_t pickRoot(const DistributedGraph &graph, std::mt19937_64 &engine) {
+    while (true) {
+        vertex_t candidate = static_cast<vertex_t>(engine() % graph.numVertices);
+        MPI_Bcast(&candidate, 1, MPI_UINT32_T, 0, MPI_COMM_WORLD);
+        unsigned long long degree = 0, found = 0;
+        if (graph.owner(candidate) == rank) degree = graph.local.degree(candidate - graph.local.firstVertex);
+        MPI_Allreduce(&degree, &found, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+        if (found > 0) return candidate;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided); // OpenMP inside the bottom-up steps
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0) std::cerr << "ERROR: MPI does not support MPI_THREAD_FUNNELED, which the OpenMP BFS steps need.\n";
+        MPI_Finalize();
+        return 1;
+    }
+    if (argc < 2 || argc > 4) {
+        if (rank == 0) std::cerr << "Usage: " << argv[0] << " <rmat:SCALE[:EDGE_FACTOR]|graph.csr|edge_list> [num_roots] [output_csr]\n";
+        MPI_Finalize();
+        return 1;
+    }
+    const int numRoots = std::max(1, argc > 2 ? std::atoi(argv[2]) : BFS_ROOTS);
+
+    DistributedGraph graph;
+    double start_time = MPI_Wtime();
+    if (!loadGraph(argv[1], graph)) {
+        MPI_Finalize();
+        return 1;
+    }
+    double load_time = MPI_Wtime() - start_time;
+    unsigned long long localEdges = graph.local.numEdges(), totalEdges = 0;
+    MPI_Allreduce(&localEdges, &totalEdges, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0) {
+        std::cout << std::fixed << std::setprecision(3) << "Graph: " << graph.numVertices << " vertices, "
+                  << totalEdges / 2 << " undirected edges over " << size << " ranks, loaded in " << load_time * 1000.0 << " ms.\n";
+    }
+
+    if (argc > 3) {
+        bool written = writeDistributedBinary(argv[3], graph, MPI_COMM_WORLD);
+        if (rank == 0 && written) std::cout << "Binary graph saved to " << argv[3] << ".\n";
+    }
+
+    // Every rank sees the same total, so they all bail out together
+    if (totalEdges == 0) {
+        if (rank == 0) std::cerr << "ERROR: Graph has no edges.\n";
+        MPI_Finalize();
+        return 1;
+    }
+
+    std::mt19937_64 engine(BFS_ROOT_SEED);
+    std::vector<double> rates, times;
+    bool valid = true;
+    for (int i = 0; i < numRoots; i++) {
+        vertex_t root = pickRoot(graph, engine);
+        MPI_Barrier(MPI_COMM_WORLD);
+        start_time = MPI_Wtime();
+        DistributedBFSResult result = distributedBFS(graph, root, MPI_COMM_WORLD);
+        double elapsed = MPI_Wtime() - start_time, slowest = 0.0;
+        MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        long long errors = validateDistributedBFS(graph, result, root, MPI_COMM_WORLD);
+        valid &= errors == 0;
+
+        rates.push_back(result.traversedEdges / slowest);
+        times.push_back(slowest * 1000.0);
+        if (rank == 0) {
+            std::cout << "  root " << std::setw(10) << root << ": " << result.visited << " vertices, " << result.levels
+                      << " levels (" << result.bottomUpLevels << " bottom-up), " << times.back() << " ms, "
+                      << rates.back() / 1e6 << " MTEPS" << (errors == 0 ? "" : "  INVALID") << "\n";
+        }
+    }
+
+    if (rank == 0) {
+        std::sort(times.begin(), times.end());
+        std::cout << "BFS time min " << times.front() << " ms, median " << times[times.size() / 2] << " ms, max "
+                  << times.back() << " ms; harmonic mean " << harmonicMean(rates) / 1e6 << " MTEPS.\n";
+        if (!valid) std::cerr << "ERROR: At least one BFS tree failed validation.\n";
+    }
+    MPI_Finalize();
+    return valid ? 0 : 1;
+}
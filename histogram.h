@@ -0,0 +1,149 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HISTOGRAM_X86 1
+#endif
+
+#define MAX_INTENSITY 256     // Grayscale intensity levels
+#define CACHE_LINE_SIZE 64    // Padding unit so neighbouring threads never share a line
+#define HISTOGRAM_TABLES 8    // Interleaved sub-histograms per thread (one per byte of a 64-bit load)
+
+// Private histogram owned by a single thread. The HISTOGRAM_TABLES copies are
+// filled round-robin so a run of identical pixels increments different memory
+// words instead of waiting on the previous store to the same counter.
+struct alignas(CACHE_LINE_SIZE) ThreadHistogram {
+    unsigned int counts[HISTOGRAM_TABLES][MAX_INTENSITY] = {};
+};
+
+// Function to spread the eight bytes of one 64-bit load over the eight tables
+inline void countWord(std::uint64_t word, ThreadHistogram &local) {
+    local.counts[0][word & 0xFF]++;
+    local.counts[1][(word >> 8) & 0xFF]++;
+    local.counts[2][(word >> 16) & 0xFF]++;
+    local.counts[3][(word >> 24) & 0xFF]++;
+    local.counts[4][(word >> 32) & 0xFF]++;
+    local.counts[5][(word >> 40) & 0xFF]++;
+    local.counts[6][(word >> 48) & 0xFF]++;
+    local.counts[7][word >> 56]++;
+}
+
+// Scalar fallback: 64-bit loads, one table per byte lane
+inline void accumulateHistogramScalar(const unsigned char *pixels, std::size_t count, ThreadHistogram &local) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, pixels + i, sizeof(word));
+        countWord(word, local);
+    }
+    for (; i < count; i++) {
+        local.counts[0][pixels[i]]++;
+    }
+}
+
+#ifdef HISTOGRAM_X86
+// AVX2: 32-byte blocks. A block whose bytes all equal its first byte (flat
+// regions, borders, saturated areas) is counted with a single add; any other
+// block falls through to the 64-bit word path.
+__attribute__((target("avx2")))
+inline void accumulateHistogramAVX2(const unsigned char *pixels, std::size_t count, ThreadHistogram &local) {
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + i));
+        __m256i first = _mm256_broadcastb_epi8(_mm256_castsi256_si128(block));
+        if (static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, first))) == 0xFFFFFFFFu) {
+            local.counts[0][pixels[i]] += 32;
+            continue;
+        }
+        std::uint64_t words[4];
+        std::memcpy(words, pixels + i, sizeof(words));
+        countWord(words[0], local);
+        countWord(words[1], local);
+        countWord(words[2], local);
+        countWord(words[3], local);
+    }
+    accumulateHistogramScalar(pixels + i, count - i, local);
+}
+
+// AVX-512BW: same scheme on 64-byte blocks using a mask compare
+__attribute__((target("avx512f,avx512bw")))
+inline void accumulateHistogramAVX512(const unsigned char *pixels, std::size_t count, ThreadHistogram &local) {
+    std::size_t i = 0;
+    for (; i + 64 <= count; i += 64) {
+        __m512i block = _mm512_loadu_si512(reinterpret_cast<const void *>(pixels + i));
+        __m512i first = _mm512_set1_epi8(static_cast<char>(pixels[i]));
+        if (_mm512_cmpeq_epi8_mask(block, first) == ~0ULL) {
+            local.counts[0][pixels[i]] += 64;
+            continue;
+        }
+        std::uint64_t words[8];
+        std::memcpy(words, pixels + i, sizeof(words));
+        for (int w = 0; w < 8; w++) {
+            countWord(words[w], local);
+        }
+    }
+    accumulateHistogramScalar(pixels + i, count - i, local);
+}
+#endif
+
+using HistogramKernel = void (*)(const unsigned char *, std::size_t, ThreadHistogram &);
+
+// Function to pick the widest kernel the running CPU supports
+inline HistogramKernel selectHistogramKernel() {
+#ifdef HISTOGRAM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) return accumulateHistogramAVX512;
+    if (__builtin_cpu_supports("avx2")) return accumulateHistogramAVX2;
+#endif
+    return accumulateHistogramScalar;
+}
+
+// Function to count a contiguous run of pixels into a thread's private tables.
+// The kernel is chosen once per process on first use.
+inline void accumulateHistogram(const unsigned char *pixels, std::size_t count, ThreadHistogram &local) {
+    static const HistogramKernel kernel = selectHistogramKernel();
+    kernel(pixels, count, local);
+}
+
+// Function to collapse one set of private tables into a histogram
+inline void foldHistogram(const ThreadHistogram &local, std::array<int, MAX_INTENSITY> &histogram) {
+    for (int bin = 0; bin < MAX_INTENSITY; bin++) {
+        unsigned int total = 0;
+        for (int t = 0; t < HISTOGRAM_TABLES; t++) {
+            total += local.counts[t][bin];
+        }
+        histogram[bin] = static_cast<int>(total);
+    }
+}
+
+// Function to histogram a pixel buffer on the calling thread
+inline void computeHistogram(const unsigned char *pixels, std::size_t count, std::array<int, MAX_INTENSITY> &histogram) {
+    ThreadHistogram local;
+    accumulateHistogram(pixels, count, local);
+    foldHistogram(local, histogram);
+}
+
+// Function to fold every thread's tables into the final histogram. Must be
+// called from inside a parallel region; the bins are shared out between the
+// threads so each output counter is written exactly once.
+inline void mergeThreadHistograms(const std::vector<ThreadHistogram> &partials, std::array<int, MAX_INTENSITY> &histogram) {
+    #pragma omp for schedule(static)
+    for (int bin = 0; bin < MAX_INTENSITY; bin++) {
+        unsigned int total = 0;
+        for (const ThreadHistogram &partial : partials) {
+            for (int t = 0; t < HISTOGRAM_TABLES; t++) {
+                total += partial.counts[t][bin];
+            }
+        }
+        histogram[bin] = static_cast<int>(total);
+    }
+}
+
+#endif // HISTOGRAM_H
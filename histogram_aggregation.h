@@ -0,0 +1,191 @@
+#ifndef HISTOGRAM_AGGREGATION_H
+#define HISTOGRAM_AGGREGATION_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+#include "histogram.h"
+
+#define HISTOGRAM_TAG 1 // Tag for partial histograms travelling up the tree
+
+// A rank's place in the aggregation tree
+struct SpanningTree {
+    int parent = -1;            // -1 on the root
+    std::vector<int> children;
+    int depth = 0;              // Hops from this rank to the root
+    int height = 0;             // Depth of the deepest rank in the whole tree
+};
+
+// Function to share the root's adjacency matrix with every rank. Rows may be
+// ragged in the input file; missing entries are treated as 0.
+inline void broadcastAdjacencyMatrix(std::vector<std::vector<int> > &adjacencyMatrix, int root, int rank, MPI_Comm comm) {
+    int numNodes = static_cast<int>(adjacencyMatrix.size());
+    MPI_Bcast(&numNodes, 1, MPI_INT, root, comm);
+
+    std::vector<int> flat(static_cast<std::size_t>(numNodes) * numNodes, 0);
+    if (rank == root) {
+        for (int u = 0; u < numNodes; u++) {
+            for (int v = 0; v < numNodes && v < static_cast<int>(adjacencyMatrix[u].size()); v++) {
+                flat[static_cast<std::size_t>(u) * numNodes + v] = adjacencyMatrix[u][v];
+            }
+        }
+    }
+    MPI_Bcast(flat.data(), static_cast<int>(flat.size()), MPI_INT, root, comm);
+
+    adjacencyMatrix.assign(numNodes, std::vector<int>(numNodes, 0));
+    for (int u = 0; u < numNodes; u++) {
+        for (int v = 0; v < numNodes; v++) {
+            adjacencyMatrix[u][v] = flat[static_cast<std::size_t>(u) * numNodes + v];
+        }
+    }
+}
+
+// Function to build a breadth-first spanning tree of the topology rooted at
+// `root`. Every rank runs the same deterministic BFS, so no messages are
+// needed to agree on the tree. BFS keeps the depth minimal, which bounds the
+// convergecast latency. Links are treated as undirected; ranks the matrix
+// does not reach are attached directly to the root.
+inline SpanningTree buildSpanningTree(const std::vector<std::vector<int> > &adjacencyMatrix, int root, int rank, int size) {
+    std::vector<int> parent(size, -2), depth(size, 0);
+    std::queue<int> frontier;
+    parent[root] = -1;
+    frontier.push(root);
+    const int numNodes = std::min(size, static_cast<int>(adjacencyMatrix.size()));
+
+    while (!frontier.empty()) {
+        int u = frontier.front();
+        frontier.pop();
+        if (u >= numNodes) continue;
+        for (int v = 0; v < numNodes; v++) {
+            bool linked = adjacencyMatrix[u][v] != 0 || adjacencyMatrix[v][u] != 0;
+            if (linked && parent[v] == -2) {
+                parent[v] = u;
+                depth[v] = depth[u] + 1;
+                frontier.push(v);
+            }
+        }
+    }
+
+    bool detached = false;
+    for (int v = 0; v < size; v++) {
+        if (parent[v] == -2) {
+            parent[v] = root;
+            depth[v] = 1;
+            detached = true;
+        }
+    }
+    if (detached && rank == root) {
+        std::cerr << "WARNING: Some ranks are not reachable in the adjacency matrix; attaching them to rank " << root << ".\n";
+    }
+
+    SpanningTree tree;
+    tree.parent = parent[rank];
+    tree.depth = depth[rank];
+    for (int v = 0; v < size; v++) {
+        if (parent[v] == rank) tree.children.push_back(v);
+        tree.height = std::max(tree.height, depth[v]);
+    }
+    return tree;
+}
+
+// Function to sum histograms up the tree. Each rank posts non-blocking
+// receives for all of its children, folds them in as they arrive, then
+// forwards the subtotal to its parent. There are no global barriers; the
+// critical path is one message per tree level. On return the root's
+// `histogram` holds the total.
+inline void convergecastHistogram(const SpanningTree &tree, std::array<int, MAX_INTENSITY> &histogram, MPI_Comm comm) {
+    const int numChildren = static_cast<int>(tree.children.size());
+    std::vector<std::array<int, MAX_INTENSITY> > received(numChildren);
+    std::vector<MPI_Request> requests(numChildren);
+    for (int c = 0; c < numChildren; c++) {
+        MPI_Irecv(received[c].data(), MAX_INTENSITY, MPI_INT, tree.children[c], HISTOGRAM_TAG, comm, &requests[c]);
+    }
+
+    for (int done = 0; done < numChildren; done++) {
+        int index;
+        MPI_Waitany(numChildren, requests.data(), &index, MPI_STATUS_IGNORE);
+        for (int i = 0; i < MAX_INTENSITY; i++) {
+            histogram[i] += received[index][i];
+        }
+    }
+
+    if (tree.parent >= 0) {
+        MPI_Request request;
+        MPI_Isend(histogram.data(), MAX_INTENSITY, MPI_INT, tree.parent, HISTOGRAM_TAG, comm, &request);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+    }
+}
+
+// Function to sum histograms onto the root with a single MPI_Reduce
+inline void reduceHistogram(std::array<int, MAX_INTENSITY> &histogram, int root, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == root) {
+        MPI_Reduce(MPI_IN_PLACE, histogram.data(), MAX_INTENSITY, MPI_INT, MPI_SUM, root, comm);
+    } else {
+        MPI_Reduce(histogram.data(), nullptr, MAX_INTENSITY, MPI_INT, MPI_SUM, root, comm);
+    }
+}
+
+// One-sided aggregation: the root exposes its histogram as an RMA window and
+// every rank adds its counts with MPI_Accumulate under a shared passive-target
+// lock as soon as they are ready. The window is created before the counting
+// starts, so a fast rank's push never waits for a slow one; the only
+// collective left is the MPI_Win_free that publishes the total on the root.
+class HistogramWindow {
+public:
+    HistogramWindow(int root, MPI_Comm comm) : root_(root), total_() {
+        MPI_Comm_rank(comm, &rank_);
+        const bool exposed = rank_ == root;
+        MPI_Win_create(exposed ? total_.data() : nullptr, exposed ? static_cast<MPI_Aint>(sizeof(total_)) : 0,
+                       sizeof(int), MPI_INFO_NULL, comm, &window_);
+    }
+    HistogramWindow(const HistogramWindow &) = delete;
+    HistogramWindow &operator=(const HistogramWindow &) = delete;
+    ~HistogramWindow() {
+        if (window_ != MPI_WIN_NULL) MPI_Win_free(&window_);
+    }
+
+    void push(const std::array<int, MAX_INTENSITY> &histogram) {
+        MPI_Win_lock(MPI_LOCK_SHARED, root_, 0, window_);
+        MPI_Accumulate(histogram.data(), MAX_INTENSITY, MPI_INT, root_, 0, MAX_INTENSITY, MPI_INT, MPI_SUM, window_);
+        MPI_Win_unlock(root_, window_);
+    }
+
+    // Function to close the window (collective); on the root `histogram` receives the total
+    void finish(std::array<int, MAX_INTENSITY> &histogram) {
+        MPI_Win_free(&window_);
+        if (rank_ == root_) histogram = total_;
+    }
+
+private:
+    int root_;
+    int rank_ = 0;
+    MPI_Win window_ = MPI_WIN_NULL;
+    std::array<int, MAX_INTENSITY> total_;
+};
+
+enum class AggregationBackend { Tree, Reduce, RMA };
+
+inline const char *aggregationName(AggregationBackend backend) {
+    switch (backend) {
+        case AggregationBackend::Tree: return "tree";
+        case AggregationBackend::Reduce: return "reduce";
+        case AggregationBackend::RMA: return "rma";
+    }
+    return "unknown";
+}
+
+inline bool parseAggregationBackend(const std::string &name, AggregationBackend &backend) {
+    if (name == "tree") backend = AggregationBackend::Tree;
+    else if (name == "reduce") backend = AggregationBackend::Reduce;
+    else if (name == "rma") backend = AggregationBackend::RMA;
+    else return false;
+    return true;
+}
+
+#endif // HISTOGRAM_AGGREGATION_H
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "histogram.h"
+#include "loop_scheduler.h"
+#include "parallel_histogram.h"
+#include "synthetic_image.h"
+
+#define BENCH_WARMUP 2   // Untimed runs before measuring
+#define BENCH_TRIALS 15  // Timed runs per configuration
+
+struct BenchResult {
+    double median = 0.0;
+    double p95 = 0.0;
+    double best = 0.0;
+};
+
+// Function to time `run` after warmup and summarize the trials
+BenchResult measure(const std::function<void()> &run, int trials) {
+    for (int i = 0; i < BENCH_WARMUP; i++) run();
+    std::vector<double> times;
+    for (int i = 0; i < trials; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        times.push_back(elapsed.count());
+    }
+    std::sort(times.begin(), times.end());
+    BenchResult result;
+    result.best = times.front();
+    result.median = times[times.size() / 2];
+    result.p95 = times[static_cast<std::size_t>(std::ceil(0.95 * times.size())) - 1];
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 6) {
+        std::cerr << "Usage: " << argv[0] << " <output_csv> [width] [height] [trials] [max_threads]" << std::endl;
+        return -1;
+    }
+    const int width = argc > 2 ? std::atoi(argv[2]) : 4096;
+    const int height = argc > 3 ? std::atoi(argv[3]) : 4096;
+    const int trials = std::max(1, argc > 4 ? std::atoi(argv[4]) : BENCH_TRIALS);
+    const int maxThreads = argc > 5 ? std::atoi(argv[5]) : omp_get_num_procs();
+
+    std::ofstream csv(argv[1]);
+    if (!csv.is_open()) {
+        std::cerr << "ERROR: Could not open output file.\n";
+        return -1;
+    }
+    csv << "distribution,width,height,strategy,threads,chunk_rows,median_ms,p95_ms,min_ms,gb_per_s,speedup,correct\n";
+
+    // Doubling thread counts up to the limit, plus the limit itself
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(std::max(1, maxThreads));
+
+    const Schedule schedules[] = {Schedule::Static, Schedule::Dynamic, Schedule::Guided, Schedule::Tiles, Schedule::WorkStealing};
+    const PixelDistribution distributions[] = {PixelDistribution::Uniform, PixelDistribution::Gaussian,
+                                               PixelDistribution::Constant, PixelDistribution::Striped};
+    const double gigabytes = static_cast<double>(width) * height / 1e9;
+    bool allCorrect = true;
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (PixelDistribution distribution : distributions) {
+        std::vector<unsigned char> image = generateImage(width, height, distribution);
+        std::array<int, MAX_INTENSITY> expected, actual;
+
+        BenchResult sequential = measure([&] { computeHistogram(image.data(), image.size(), expected); }, trials);
+        std::cout << "\n[" << distributionName(distribution) << "] " << width << "x" << height
+                  << " sequential: median " << sequential.median << " ms, p95 " << sequential.p95 << " ms\n";
+        csv << distributionName(distribution) << "," << width << "," << height << ",sequential,1,0,"
+            << sequential.median << "," << sequential.p95 << "," << sequential.best << ","
+            << gigabytes / (sequential.median / 1000.0) << ",1,1\n";
+
+        for (Schedule schedule : schedules) {
+            for (int threads : threadCounts) {
+                SchedulerConfig config;
+                config.schedule = schedule;
+                config.numThreads = threads;
+                config = resolveConfig(config, width, height);
+
+                BenchResult result = measure([&] { computeHistogramScheduled(image.data(), width, height, actual, config); }, trials);
+                bool correct = actual == expected;
+                allCorrect &= correct;
+                double speedup = sequential.median / result.median;
+
+                std::cout << "  " << std::setw(8) << scheduleName(schedule) << " threads " << std::setw(3) << threads
+                          << ": median " << result.median << " ms, p95 " << result.p95 << " ms, speedup "
+                          << speedup << "x" << (correct ? "" : "  MISMATCH") << "\n";
+                csv << distributionName(distribution) << "," << width << "," << height << "," << scheduleName(schedule) << ","
+                    << threads << "," << config.chunkRows << "," << result.median << "," << result.p95 << "," << result.best << ","
+                    << gigabytes / (result.median / 1000.0) << "," << speedup << "," << (correct ? 1 : 0) << "\n";
+            }
+        }
+    }
+
+    std::cout << "\nResults saved to " << argv[1] << ".\n";
+    if (!allCorrect) {
+        std::cerr << "ERROR: At least one strategy produced a histogram different from the sequential one.\n";
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <array>
+#include <sstream>
+#include <omp.h>
+#include <chrono>
+#include <math.h>
+#include <cstdlib>
+#include "histogram.h"
+#include "pgm_io.h"
+#include "loop_scheduler.h"
+#include "parallel_histogram.h"
+#include "trace.h"
+
+// Function to compute the histogram sequentially
+void computeHistogramSequential(const unsigned char *image, int width, int height, std::array<int, MAX_INTENSITY> &histogram) {
+    computeHistogram(image, static_cast<std::size_t>(width) * height, histogram);
+}
+
+
+
+// Function to compute the histogram in parallel using OpenMP. The loop policy
+// comes from `config`; when a tracer is given every chunk is recorded into it.
+void computeHistogramParallel(const unsigned char *image, int width, int height, std::array<int, MAX_INTENSITY> &histogram,
+                              const SchedulerConfig &config, Tracer *tracer = nullptr) {
+    auto global_start = std::chrono::high_resolution_clock::now();
+    computeHistogramScheduled(image, width, height, histogram, config, tracer);
+    auto global_end = std::chrono::high_resolution_clock::now();
+    if (tracer == nullptr) return;
+
+    std::chrono::duration<double, std::milli> diff = global_end - global_start;
+    std::cout << "Total Execution Time for Parallelization with Schedule = " << scheduleName(config.schedule)
+              << ", NumThreads = " << config.numThreads << " and ChunkSize = " << config.chunkRows << " rows";
+    if (config.schedule == Schedule::Tiles) std::cout << " x " << config.tileWidth << " columns";
+    std::cout << " with Time: " << diff.count() << " ms.\n";
+}
+
+// Function to print the histogram
+void printHistogram(const std::array<int, MAX_INTENSITY> &histogram) {
+    for (int i = 0; i < MAX_INTENSITY; i++) {
+        std::cout << "Intensity " << i << ": " << histogram[i] << std::endl;
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 6) {
+        std::cerr << "Usage: " << argv[0] << " <input_pgm_file> [static|dynamic|guided|tiles|stealing|auto] [num_threads] [chunk_rows] [trace_json]" << std::endl;
+        return -1;
+    }
+
+    SchedulerConfig config;
+    if (argc > 2 && !parseSchedule(argv[2], config.schedule)) {
+        std::cerr << "ERROR: Unknown schedule " << argv[2] << std::endl;
+        return -1;
+    }
+    if (argc > 3) config.numThreads = std::atoi(argv[3]);
+    if (argc > 4) config.chunkRows = std::atoi(argv[4]);
+
+    PGMImage pgm;
+    if (!pgm.open(argv[1])) {
+        std::cerr << "Error reading the image.\n";
+        return -1;
+    }
+    const unsigned char *image = pgm.pixels();
+    int width = pgm.width();
+    int height = pgm.height();
+
+    std::array<int, MAX_INTENSITY> histogram;
+
+    std::cout << "Computing histogram sequentially...\n";
+    computeHistogramSequential(image, width, height, histogram);
+    printHistogram(histogram);
+
+    if (config.schedule == Schedule::Auto) {
+        std::cout << "\nCalibrating schedule...\n";
+        std::array<int, MAX_INTENSITY> scratch;
+        config = autoTuneSchedule(width, height, [&](const SchedulerConfig &candidate, int rows) {
+            computeHistogramParallel(image, width, rows, scratch, candidate);
+        });
+        std::cout << "Selected schedule " << scheduleName(config.schedule) << " with " << config.numThreads
+                  << " threads and " << config.chunkRows << " rows per chunk.\n";
+    }
+    config = resolveConfig(config, width, height);
+
+    std::cout << "\nComputing histogram in parallel...\n";
+    Tracer tracer(config.numThreads);
+    computeHistogramParallel(image, width, height, histogram, config, &tracer);
+    tracer.printImbalanceSummary(std::cout);
+    if (argc > 5 && tracer.writeChromeTrace(argv[5])) {
+        std::cout << "Chunk trace saved to " << argv[5] << ".\n";
+    }
+    printHistogram(histogram);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "histogram.h"
+#include "pgm_io.h"
+#include "image_kernels.h"
+
+#define KERNEL_TRIALS 5 // Best-of-N timing for both the reference and the tiled kernel
+
+// Naive single-threaded references: one output pixel at a time, clamped
+// neighbourhood reads, no tiling or vectorization
+
+void referenceEqualize(const unsigned char *src, unsigned char *dst, int width, int height) {
+    std::array<int, MAX_INTENSITY> histogram;
+    histogram.fill(0);
+    std::size_t count = static_cast<std::size_t>(width) * height;
+    for (std::size_t i = 0; i < count; i++) histogram[src[i]]++;
+    std::array<unsigned char, MAX_INTENSITY> lut = buildEqualizationLUT(histogram, count);
+    for (std::size_t i = 0; i < count; i++) dst[i] = lut[src[i]];
+}
+
+void referenceGaussian(const unsigned char *src, unsigned char *dst, int width, int height) {
+    const int weights[5] = {1, 4, 6, 4, 1};
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int sum = 0;
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    sum += weights[dy + 2] * weights[dx + 2] * src[clampIndex(y + dy, height) * width + clampIndex(x + dx, width)];
+                }
+            }
+            dst[y * width + x] = static_cast<unsigned char>((sum + 128) >> 8);
+        }
+    }
+}
+
+void referenceBox(const unsigned char *src, unsigned char *dst, int width, int height, int radius) {
+    const int area = (2 * radius + 1) * (2 * radius + 1);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int sum = 0;
+            for (int dy = -radius; dy <= radius; dy++) {
+                for (int dx = -radius; dx <= radius; dx++) {
+                    sum += src[clampIndex(y + dy, height) * width + clampIndex(x + dx, width)];
+                }
+            }
+            dst[y * width + x] = static_cast<unsigned char>((sum + area / 2) / area);
+        }
+    }
+}
+
+void referenceSobel(const unsigned char *src, unsigned char *dst, int width, int height) {
+    auto at = [&](int y, int x) { return static_cast<int>(src[clampIndex(y, height) * width + clampIndex(x, width)]); };
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int gx = -at(y - 1, x - 1) + at(y - 1, x + 1) - 2 * at(y, x - 1) + 2 * at(y, x + 1) - at(y + 1, x - 1) + at(y + 1, x + 1);
+            int gy = -at(y - 1, x - 1) - 2 * at(y - 1, x) - at(y - 1, x + 1) + at(y + 1, x - 1) + 2 * at(y + 1, x) + at(y + 1, x + 1);
+            dst[y * width + x] = static_cast<unsigned char>(std::min(255, std::abs(gx) + std::abs(gy)));
+        }
+    }
+}
+
+// Function to time a kernel, best of KERNEL_TRIALS runs
+double timeKernel(const std::function<void()> &kernel) {
+    double best = -1.0;
+    for (int trial = 0; trial < KERNEL_TRIALS; trial++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        kernel();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        if (best < 0 || elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+// Function to run one kernel against its reference, check the outputs match
+// and report the speedup. Returns false on any mismatching pixel.
+bool compareKernel(const std::string &name, const std::string &outputFile, int width, int height,
+                   const std::function<void(unsigned char *)> &reference, const std::function<void(unsigned char *)> &tiled) {
+    std::size_t count = static_cast<std::size_t>(width) * height;
+    std::vector<unsigned char> expected(count), actual(count);
+    double referenceTime = timeKernel([&] { reference(expected.data()); });
+    double tiledTime = timeKernel([&] { tiled(actual.data()); });
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < count; i++) mismatches += expected[i] != actual[i];
+
+    std::cout << name << " -> reference: " << referenceTime << " ms, tiled: " << tiledTime << " ms, speedup: "
+              << referenceTime / tiledTime << "x, " << (mismatches == 0 ? "outputs match" : "MISMATCH") << ".\n";
+    if (mismatches != 0) {
+        std::cerr << "ERROR: " << name << " differs from the reference at " << mismatches << " pixels.\n";
+    }
+    writePGM(outputFile, actual.data(), width, height);
+    return mismatches == 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <input_pgm_file> <output_prefix> [box_radius]" << std::endl;
+        return -1;
+    }
+
+    PGMImage pgm;
+    if (!pgm.open(argv[1])) {
+        std::cerr << "Error reading the image.\n";
+        return -1;
+    }
+    const unsigned char *image = pgm.pixels();
+    const int width = pgm.width();
+    const int height = pgm.height();
+    const int radius = std::min(std::max(argc > 3 ? std::atoi(argv[3]) : 3, 0), MAX_BOX_RADIUS);
+    const std::string prefix = argv[2];
+
+    std::cout << "Running kernels on " << width << "x" << height << " image with " << omp_get_max_threads() << " threads...\n";
+    bool ok = true;
+    ok &= compareKernel("Equalization", prefix + "_equalized.pgm", width, height,
+                        [&](unsigned char *out) { referenceEqualize(image, out, width, height); },
+                        [&](unsigned char *out) { equalizeHistogram(image, out, width, height); });
+    ok &= compareKernel("Gaussian 5x5", prefix + "_gaussian.pgm", width, height,
+                        [&](unsigned char *out) { referenceGaussian(image, out, width, height); },
+                        [&](unsigned char *out) { gaussianBlur(image, out, width, height); });
+    ok &= compareKernel("Box r=" + std::to_string(radius), prefix + "_box.pgm", width, height,
+                        [&](unsigned char *out) { referenceBox(image, out, width, height, radius); },
+                        [&](unsigned char *out) { boxFilter(image, out, width, height, radius); });
+    ok &= compareKernel("Sobel", prefix + "_sobel.pgm", width, height,
+                        [&](unsigned char *out) { referenceSobel(image, out, width, height); },
+                        [&](unsigned char *out) { sobelEdges(image, out, width, height); });
+    return ok ? 0 : -1;
+}
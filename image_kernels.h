@@ -0,0 +1,268 @@
+#ifndef IMAGE_KERNELS_H
+#define IMAGE_KERNELS_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "histogram.h"
+#include "loop_scheduler.h"
+#include "parallel_histogram.h"
+
+#define KERNEL_TILE_ROWS 64     // Tile height; halo rows are recomputed per tile
+#define KERNEL_TILE_COLS 1024   // Tile width; keeps a tile's 16-bit scratch inside L2
+#define MAX_BOX_RADIUS 31       // Largest radius for which the fixed-point box divide is exact
+
+// All kernels work on row-major 8-bit images (stride == width) and replicate
+// the border pixels. Work is split into 2D tiles by runSchedule; inside a
+// tile each source row is first copied into a padded line so the inner loops
+// have no bounds checks and vectorize with `omp simd`.
+
+// Function to build the default tile configuration for the kernels
+inline SchedulerConfig kernelTiles(int numThreads = 0) {
+    SchedulerConfig config;
+    config.schedule = Schedule::Tiles;
+    config.numThreads = numThreads;
+    config.chunkRows = KERNEL_TILE_ROWS;
+    config.tileWidth = KERNEL_TILE_COLS;
+    return config;
+}
+
+inline int clampIndex(int i, int n) {
+    return std::min(std::max(i, 0), n - 1);
+}
+
+// Function to copy columns [x0 - pad, x1 + pad) of row y into `line`, replicating edges
+inline void loadPaddedRow(const unsigned char *src, int width, int y, int x0, int x1, int pad, unsigned char *line) {
+    const unsigned char *row = src + static_cast<std::size_t>(y) * width;
+    int k = 0;
+    for (int x = x0 - pad; x < std::min(0, x1 + pad); x++) line[k++] = row[0];
+    int begin = std::max(0, x0 - pad);
+    int end = std::min(width, x1 + pad);
+    if (end > begin) {
+        std::copy(row + begin, row + end, line + k);
+        k += end - begin;
+    }
+    for (int x = std::max(width, x0 - pad); x < x1 + pad; x++) line[k++] = row[width - 1];
+}
+
+// ---------------------------------------------------------------------------
+// Histogram equalization: histogram -> CDF -> LUT -> remap
+
+// Function to build the equalization LUT from a histogram of `pixelCount` pixels
+inline std::array<unsigned char, MAX_INTENSITY> buildEqualizationLUT(const std::array<int, MAX_INTENSITY> &histogram, std::size_t pixelCount) {
+    std::array<unsigned char, MAX_INTENSITY> lut;
+    std::uint64_t cdf = 0, cdfMin = 0;
+    for (int v = 0; v < MAX_INTENSITY && cdfMin == 0; v++) cdfMin = static_cast<std::uint64_t>(histogram[v]);
+
+    const std::uint64_t range = pixelCount - cdfMin;
+    for (int v = 0; v < MAX_INTENSITY; v++) {
+        cdf += static_cast<std::uint64_t>(histogram[v]);
+        if (range == 0) {
+            lut[v] = static_cast<unsigned char>(v); // Single-valued image: leave it alone
+        } else {
+            std::uint64_t above = cdf > cdfMin ? cdf - cdfMin : 0;
+            lut[v] = static_cast<unsigned char>((above * 255 + range / 2) / range);
+        }
+    }
+    return lut;
+}
+
+inline void applyLUTScalar(const unsigned char *src, unsigned char *dst, std::size_t count, const unsigned char *lut) {
+    for (std::size_t i = 0; i < count; i++) dst[i] = lut[src[i]];
+}
+
+#ifdef HISTOGRAM_X86
+// AVX-512 VBMI: two 128-entry byte permutes cover the table, the index's top
+// bit picks between them
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+inline void applyLUTVBMI(const unsigned char *src, unsigned char *dst, std::size_t count, const unsigned char *lut) {
+    const __m512i t0 = _mm512_loadu_si512(lut);
+    const __m512i t1 = _mm512_loadu_si512(lut + 64);
+    const __m512i t2 = _mm512_loadu_si512(lut + 128);
+    const __m512i t3 = _mm512_loadu_si512(lut + 192);
+    std::size_t i = 0;
+    for (; i + 64 <= count; i += 64) {
+        __m512i index = _mm512_loadu_si512(src + i);
+        __m512i low = _mm512_permutex2var_epi8(t0, index, t1);
+        __m512i high = _mm512_permutex2var_epi8(t2, index, t3);
+        _mm512_storeu_si512(dst + i, _mm512_mask_blend_epi8(_mm512_movepi8_mask(index), low, high));
+    }
+    applyLUTScalar(src + i, dst + i, count - i, lut);
+}
+#endif
+
+using LUTKernel = void (*)(const unsigned char *, unsigned char *, std::size_t, const unsigned char *);
+
+// Function to remap `count` pixels through a 256-entry LUT
+inline void applyLUT(const unsigned char *src, unsigned char *dst, std::size_t count, const std::array<unsigned char, MAX_INTENSITY> &lut) {
+    static const LUTKernel kernel = [] {
+#ifdef HISTOGRAM_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512vbmi")) return static_cast<LUTKernel>(applyLUTVBMI);
+#endif
+        return static_cast<LUTKernel>(applyLUTScalar);
+    }();
+    kernel(src, dst, count, lut.data());
+}
+
+// Function to equalize `src` into `dst`
+inline void equalizeHistogram(const unsigned char *src, unsigned char *dst, int width, int height, SchedulerConfig config = kernelTiles()) {
+    config = resolveConfig(config, width, height);
+
+    std::array<int, MAX_INTENSITY> histogram;
+    computeHistogramScheduled(src, width, height, histogram, config);
+
+    const std::array<unsigned char, MAX_INTENSITY> lut = buildEqualizationLUT(histogram, static_cast<std::size_t>(width) * height);
+    runSchedule(config, width, height, [&](int, const LoopChunk &tile) {
+        for (int y = tile.rowBegin; y < tile.rowEnd; y++) {
+            std::size_t offset = static_cast<std::size_t>(y) * width + tile.colBegin;
+            applyLUT(src + offset, dst + offset, tile.colEnd - tile.colBegin, lut);
+        }
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Separable 5x5 Gaussian blur with the binomial kernel [1 4 6 4 1] / 16.
+// Integer arithmetic throughout, so the result is exact and fits in 16 bits.
+
+inline void gaussianTile(const unsigned char *src, unsigned char *dst, int width, int height, const LoopChunk &tile) {
+    const int cols = tile.colEnd - tile.colBegin;
+    const int rows = tile.rowEnd - tile.rowBegin;
+    thread_local std::vector<unsigned char> line;
+    thread_local std::vector<std::uint16_t> horizontal;
+    line.resize(cols + 4);
+    horizontal.resize(static_cast<std::size_t>(rows + 4) * cols);
+
+    for (int r = 0; r < rows + 4; r++) {
+        loadPaddedRow(src, width, clampIndex(tile.rowBegin - 2 + r, height), tile.colBegin, tile.colEnd, 2, line.data());
+        const unsigned char *l = line.data();
+        std::uint16_t *out = &horizontal[static_cast<std::size_t>(r) * cols];
+        #pragma omp simd
+        for (int x = 0; x < cols; x++) {
+            out[x] = static_cast<std::uint16_t>(l[x] + 4 * l[x + 1] + 6 * l[x + 2] + 4 * l[x + 3] + l[x + 4]);
+        }
+    }
+
+    for (int r = 0; r < rows; r++) {
+        const std::uint16_t *a = &horizontal[static_cast<std::size_t>(r) * cols];
+        const std::uint16_t *b = a + cols, *c = b + cols, *d = c + cols, *e = d + cols;
+        unsigned char *out = dst + static_cast<std::size_t>(tile.rowBegin + r) * width + tile.colBegin;
+        #pragma omp simd
+        for (int x = 0; x < cols; x++) {
+            out[x] = static_cast<unsigned char>((a[x] + 4 * b[x] + 6 * c[x] + 4 * d[x] + e[x] + 128) >> 8);
+        }
+    }
+}
+
+// Function to blur `src` into `dst` with a 5x5 Gaussian
+inline void gaussianBlur(const unsigned char *src, unsigned char *dst, int width, int height, SchedulerConfig config = kernelTiles()) {
+    config = resolveConfig(config, width, height);
+    runSchedule(config, width, height, [&](int, const LoopChunk &tile) {
+        gaussianTile(src, dst, width, height, tile);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// (2r+1)x(2r+1) box filter with running sums: a sliding sum along each row,
+// then per-column sums that add the entering row and drop the leaving one.
+// The final divide is a multiply by a 32.32 fixed-point reciprocal, exact for
+// every sum a radius <= MAX_BOX_RADIUS can produce.
+
+inline void boxTile(const unsigned char *src, unsigned char *dst, int width, int height, int radius, const LoopChunk &tile) {
+    const int cols = tile.colEnd - tile.colBegin;
+    const int rows = tile.rowEnd - tile.rowBegin;
+    const int taps = 2 * radius + 1;
+    const std::uint64_t area = static_cast<std::uint64_t>(taps) * taps;
+    const std::uint64_t reciprocal = ((std::uint64_t(1) << 32) + area - 1) / area;
+    thread_local std::vector<unsigned char> line;
+    thread_local std::vector<std::uint16_t> horizontal;
+    thread_local std::vector<std::uint32_t> columns;
+    line.resize(cols + 2 * radius);
+    horizontal.resize(static_cast<std::size_t>(rows + 2 * radius) * cols);
+    columns.assign(cols, 0);
+
+    for (int r = 0; r < rows + 2 * radius; r++) {
+        loadPaddedRow(src, width, clampIndex(tile.rowBegin - radius + r, height), tile.colBegin, tile.colEnd, radius, line.data());
+        const unsigned char *l = line.data();
+        std::uint16_t *out = &horizontal[static_cast<std::size_t>(r) * cols];
+        unsigned int sum = 0;
+        for (int k = 0; k < taps; k++) sum += l[k];
+        out[0] = static_cast<std::uint16_t>(sum);
+        for (int x = 1; x < cols; x++) {
+            sum += l[x + 2 * radius];
+            sum -= l[x - 1];
+            out[x] = static_cast<std::uint16_t>(sum);
+        }
+    }
+
+    std::uint32_t *column = columns.data();
+    for (int r = 0; r < taps; r++) {
+        const std::uint16_t *h = &horizontal[static_cast<std::size_t>(r) * cols];
+        #pragma omp simd
+        for (int x = 0; x < cols; x++) column[x] += h[x];
+    }
+    for (int r = 0; r < rows; r++) {
+        unsigned char *out = dst + static_cast<std::size_t>(tile.rowBegin + r) * width + tile.colBegin;
+        #pragma omp simd
+        for (int x = 0; x < cols; x++) {
+            out[x] = static_cast<unsigned char>(((column[x] + area / 2) * reciprocal) >> 32);
+        }
+        if (r + 1 == rows) break;
+        const std::uint16_t *leaving = &horizontal[static_cast<std::size_t>(r) * cols];
+        const std::uint16_t *entering = &horizontal[static_cast<std::size_t>(r + taps) * cols];
+        #pragma omp simd
+        for (int x = 0; x < cols; x++) column[x] += entering[x] - leaving[x];
+    }
+}
+
+// Function to box-filter `src` into `dst`; radius is clamped to [0, MAX_BOX_RADIUS]
+inline void boxFilter(const unsigned char *src, unsigned char *dst, int width, int height, int radius, SchedulerConfig config = kernelTiles()) {
+    radius = std::min(std::max(radius, 0), MAX_BOX_RADIUS);
+    config = resolveConfig(config, width, height);
+    runSchedule(config, width, height, [&](int, const LoopChunk &tile) {
+        boxTile(src, dst, width, height, radius, tile);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Sobel edge magnitude, |gx| + |gy| saturated to 255
+
+inline void sobelTile(const unsigned char *src, unsigned char *dst, int width, int height, const LoopChunk &tile) {
+    const int cols = tile.colEnd - tile.colBegin;
+    thread_local std::vector<unsigned char> lines;
+    lines.resize(3 * static_cast<std::size_t>(cols + 2));
+    unsigned char *above = lines.data();
+    unsigned char *middle = above + cols + 2;
+    unsigned char *below = middle + cols + 2;
+
+    loadPaddedRow(src, width, clampIndex(tile.rowBegin - 1, height), tile.colBegin, tile.colEnd, 1, above);
+    loadPaddedRow(src, width, tile.rowBegin, tile.colBegin, tile.colEnd, 1, middle);
+    for (int y = tile.rowBegin; y < tile.rowEnd; y++) {
+        loadPaddedRow(src, width, clampIndex(y + 1, height), tile.colBegin, tile.colEnd, 1, below);
+        const unsigned char *p = above, *c = middle, *n = below;
+        unsigned char *out = dst + static_cast<std::size_t>(y) * width + tile.colBegin;
+        #pragma omp simd
+        for (int x = 0; x < cols; x++) {
+            int gx = (p[x + 2] - p[x]) + 2 * (c[x + 2] - c[x]) + (n[x + 2] - n[x]);
+            int gy = (n[x] + 2 * n[x + 1] + n[x + 2]) - (p[x] + 2 * p[x + 1] + p[x + 2]);
+            int magnitude = (gx < 0 ? -gx : gx) + (gy < 0 ? -gy : gy);
+            out[x] = static_cast<unsigned char>(magnitude > 255 ? 255 : magnitude);
+        }
+        unsigned char *recycled = above;
+        above = middle;
+        middle = below;
+        below = recycled;
+    }
+}
+
+// Function to write the Sobel gradient magnitude of `src` into `dst`
+inline void sobelEdges(const unsigned char *src, unsigned char *dst, int width, int height, SchedulerConfig config = kernelTiles()) {
+    config = resolveConfig(config, width, height);
+    runSchedule(config, width, height, [&](int, const LoopChunk &tile) {
+        sobelTile(src, dst, width, height, tile);
+    });
+}
+
+#endif // IMAGE_KERNELS_H
@@ -0,0 +1,299 @@
+#ifndef IMAGE_SERVICE_H
+#define IMAGE_SERVICE_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "histogram.h"
+#include "image_kernels.h"
+#include "pgm_io.h"
+
+#define SERVICE_JOB_TAG 10    // Root -> worker: one job descriptor
+#define SERVICE_DONE_TAG 11   // Worker -> root: id, success flag, service time
+#define SERVICE_STOP_TAG 12   // Root -> worker: shut down
+#define SERVICE_QUEUE 1024    // Job lines buffered between the source reader and the dispatcher
+#define SERVICE_POLL_MS 100   // Spool directory polling interval
+#define SERVICE_IDLE_US 200   // Root's nap when both new lines and busy workers may bring work
+
+// Job descriptors are text lines: <input_pgm> <output_file> [histogram|equalize].
+// Blank lines and lines starting with '#' are ignored; a line reading "stop"
+// drains the outstanding jobs and shuts the service down.
+
+struct ServiceJob {
+    long long id = 0;
+    std::string line;
+    double arrival = 0.0;    // MPI_Wtime on the root when the line was read
+    double latency = 0.0;    // Arrival to completion, seconds
+    int worker = -1;
+    bool ok = false;
+};
+
+// Job lines between the reader thread and the dispatcher. Unlike the
+// lock-free BoundedQueue, whose blocking pop polls, an empty pop sleeps on a
+// condition variable until the reader pushes, so an idle service stays idle.
+class JobLineQueue {
+public:
+    explicit JobLineQueue(std::size_t capacity) : capacity(capacity) {}
+
+    void push(const std::string &line) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return lines.size() < capacity; });
+        lines.push_back(line);
+        notEmpty.notify_one();
+    }
+
+    bool tryPop(std::string &line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lines.empty()) return false;
+        take(line);
+        return true;
+    }
+
+    std::string pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return !lines.empty(); });
+        std::string line;
+        take(line);
+        return line;
+    }
+
+private:
+    void take(std::string &line) {
+        line = std::move(lines.front());
+        lines.pop_front();
+        notFull.notify_one();
+    }
+
+    const std::size_t capacity;
+    std::deque<std::string> lines;
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull;
+};
+
+// Function to feed job lines into `lines` until a "stop" line. A spool
+// directory is polled for *.job files, which are renamed to *.job.done once
+// read. A FIFO is reopened whenever its writer closes it. A regular file is
+// read once. Runs on its own thread on the root and makes no MPI calls.
+inline void readJobSource(const std::string &source, JobLineQueue &lines) {
+    namespace fs = std::filesystem;
+    bool stop = false;
+    auto feed = [&](std::istream &in) {
+        std::string line;
+        while (!stop && std::getline(in, line)) {
+            line.erase(0, line.find_first_not_of(" \t\r"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty() || line[0] == '#') continue;
+            stop = line == "stop";
+            lines.push(line);
+        }
+    };
+
+    std::error_code error;
+    if (fs::is_directory(source, error)) {
+        while (!stop) {
+            std::vector<fs::path> spooled;
+            for (const fs::directory_entry &entry : fs::directory_iterator(source, error)) {
+                if (entry.path().extension() == ".job") spooled.push_back(entry.path());
+            }
+            std::sort(spooled.begin(), spooled.end()); // Name order is submission order
+            for (const fs::path &path : spooled) {
+                if (stop) break;
+                std::ifstream in(path);
+                feed(in);
+                in.close();
+                fs::rename(path, path.string() + ".done", error);
+            }
+            if (spooled.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(SERVICE_POLL_MS));
+        }
+        return;
+    }
+
+    const bool fifo = fs::is_fifo(source, error);
+    do {
+        std::ifstream in(source); // Blocks on a FIFO until a writer appears
+        if (!in.is_open()) {
+            std::cerr << "ERROR: Could not open job source " << source << std::endl;
+            break;
+        }
+        feed(in);
+    } while (fifo && !stop);
+    if (!stop) lines.push("stop");
+}
+
+// Function to run one job on the calling rank
+inline bool processServiceJob(const std::string &line) {
+    std::istringstream fields(line);
+    std::string input, output, operation = "histogram";
+    if (!(fields >> input >> output)) return false;
+    fields >> operation;
+
+    PGMImage image;
+    if (!image.open(input)) return false;
+    if (operation == "equalize") {
+        std::vector<unsigned char> equalized(image.pixelCount());
+        equalizeHistogram(image.pixels(), equalized.data(), image.width(), image.height());
+        return writePGM(output, equalized.data(), image.width(), image.height());
+    }
+    if (operation != "histogram") return false;
+
+    std::array<int, MAX_INTENSITY> histogram;
+    computeHistogram(image.pixels(), image.pixelCount(), histogram);
+    std::ofstream file(output);
+    for (int i = 0; i < MAX_INTENSITY; i++) file << histogram[i] << "\n";
+    return static_cast<bool>(file);
+}
+
+// Function for a worker rank: take jobs from `root` until told to stop
+inline void serviceWorker(int root, MPI_Comm comm) {
+    std::vector<char> buffer;
+    while (true) {
+        MPI_Status status;
+        MPI_Probe(root, MPI_ANY_TAG, comm, &status);
+        if (status.MPI_TAG == SERVICE_STOP_TAG) {
+            MPI_Recv(nullptr, 0, MPI_CHAR, root, SERVICE_STOP_TAG, comm, MPI_STATUS_IGNORE);
+            return;
+        }
+        int length;
+        MPI_Get_count(&status, MPI_CHAR, &length);
+        buffer.resize(length);
+        MPI_Recv(buffer.data(), length, MPI_CHAR, root, SERVICE_JOB_TAG, comm, MPI_STATUS_IGNORE);
+
+        // Payload is "<id> <job line>"
+        std::string payload(buffer.begin(), buffer.end());
+        std::size_t split = payload.find(' ');
+        double start = MPI_Wtime();
+        bool ok = processServiceJob(payload.substr(split + 1));
+        double result[3] = {std::stod(payload.substr(0, split)), ok ? 1.0 : 0.0, MPI_Wtime() - start};
+        MPI_Send(result, 3, MPI_DOUBLE, root, SERVICE_DONE_TAG, comm);
+    }
+}
+
+// Function for the root: read jobs from `source` and hand each one to
+// whichever worker is idle. Completions are polled with MPI_Iprobe so new
+// jobs keep being accepted while others run. When nothing is ready the root
+// blocks on the one event that can bring work: a completion (MPI_Probe) when
+// every worker is busy or the service is draining, the next job line (a
+// condition-variable wait on the reader) when every worker is idle, and a
+// short nap in between. Returns the finished
+// jobs in submission order.
+inline std::vector<ServiceJob> serviceMaster(const std::string &source, int root, MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    JobLineQueue lines(SERVICE_QUEUE);
+    std::thread reader(readJobSource, source, std::ref(lines));
+
+    std::vector<ServiceJob> jobs;
+    std::deque<long long> pending;
+    std::vector<int> idle;
+    for (int r = 0; r < size; r++) {
+        if (r != root) idle.push_back(r);
+    }
+    const int workers = static_cast<int>(idle.size());
+    bool stopping = false;
+    auto accept = [&](const std::string &line) {
+        if (line == "stop") {
+            stopping = true;
+            return;
+        }
+        ServiceJob job;
+        job.id = static_cast<long long>(jobs.size());
+        job.line = line;
+        job.arrival = MPI_Wtime();
+        jobs.push_back(job);
+        pending.push_back(job.id);
+    };
+
+    while (!stopping || !pending.empty() || static_cast<int>(idle.size()) < workers) {
+        bool progressed = false;
+        std::string line;
+        while (!stopping && lines.tryPop(line)) {
+            progressed = true;
+            accept(line);
+        }
+
+        while (!pending.empty() && !idle.empty()) {
+            ServiceJob &job = jobs[pending.front()];
+            pending.pop_front();
+            job.worker = idle.back();
+            idle.pop_back();
+            std::string payload = std::to_string(job.id) + " " + job.line;
+            MPI_Send(payload.data(), static_cast<int>(payload.size()), MPI_CHAR, job.worker, SERVICE_JOB_TAG, comm);
+            progressed = true;
+        }
+
+        int flag = 1;
+        while (flag) {
+            MPI_Status status;
+            MPI_Iprobe(MPI_ANY_SOURCE, SERVICE_DONE_TAG, comm, &flag, &status);
+            if (!flag) break;
+            double result[3];
+            MPI_Recv(result, 3, MPI_DOUBLE, status.MPI_SOURCE, SERVICE_DONE_TAG, comm, MPI_STATUS_IGNORE);
+            ServiceJob &job = jobs[static_cast<long long>(result[0])];
+            job.ok = result[1] != 0.0;
+            job.latency = MPI_Wtime() - job.arrival;
+            idle.push_back(status.MPI_SOURCE);
+            progressed = true;
+        }
+        if (progressed) continue;
+
+        const bool busy = static_cast<int>(idle.size()) < workers;
+        if (busy && (stopping || !pending.empty())) {
+            MPI_Status status;
+            MPI_Probe(MPI_ANY_SOURCE, SERVICE_DONE_TAG, comm, &status); // Received on the next pass
+        } else if (!busy && !stopping) {
+            accept(lines.pop());
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(SERVICE_IDLE_US));
+        }
+    }
+
+    for (int r = 0; r < size; r++) {
+        if (r != root) MPI_Send(nullptr, 0, MPI_CHAR, r, SERVICE_STOP_TAG, comm);
+    }
+    reader.join();
+    return jobs;
+}
+
+// Function to print throughput and latency percentiles and write one line per job.
+// Throughput is measured from the first arrival to the last completion.
+inline void reportService(const std::vector<ServiceJob> &jobs, const std::string &filename) {
+    std::ofstream file(filename);
+    std::vector<double> latencies;
+    int failed = 0;
+    double first = 0.0, last = 0.0;
+    for (const ServiceJob &job : jobs) {
+        first = job.id == 0 ? job.arrival : std::min(first, job.arrival);
+        last = std::max(last, job.arrival + job.latency);
+        file << job.id << " " << job.line << " " << (job.ok ? "ok" : "failed") << " "
+             << job.latency * 1000.0 << " ms rank " << job.worker << "\n";
+        latencies.push_back(job.latency * 1000.0);
+        failed += job.ok ? 0 : 1;
+    }
+    if (latencies.empty()) {
+        std::cout << "No jobs received.\n";
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double q) {
+        return latencies[static_cast<std::size_t>(std::ceil(q * latencies.size())) - 1];
+    };
+    const double elapsed = last - first;
+    std::cout << jobs.size() << " jobs (" << failed << " failed) in " << elapsed << " s: "
+              << jobs.size() / elapsed << " jobs/s, latency p50 " << percentile(0.50) << " ms, p95 "
+              << percentile(0.95) << " ms, p99 " << percentile(0.99) << " ms, max " << latencies.back() << " ms.\n";
+}
+
+#endif // IMAGE_SERVICE_H
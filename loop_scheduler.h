@@ -0,0 +1,236 @@
+#ifndef LOOP_SCHEDULER_H
+#define LOOP_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include <unistd.h>
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+#define MIN_CHUNK_BYTES (16 * 1024) // Below this, scheduling overhead dominates the work
+#define CALIBRATION_BYTES (4 << 20) // Image prefix timed by the auto-tuner
+#define CALIBRATION_TRIALS 2
+
+enum class Schedule { Static, Dynamic, Guided, Tiles, WorkStealing, Auto };
+
+// A rectangle of the image handed to one thread: rows [rowBegin, rowEnd),
+// columns [colBegin, colEnd)
+struct LoopChunk {
+    int rowBegin, rowEnd;
+    int colBegin, colEnd;
+};
+
+struct SchedulerConfig {
+    Schedule schedule = Schedule::Auto;
+    int numThreads = 0;   // 0 = one per core
+    int chunkRows = 0;    // Rows per chunk (tile height for Schedule::Tiles); 0 = derive from width
+    int tileWidth = 0;    // Columns per tile for Schedule::Tiles; 0 = derive from cache size
+};
+
+inline const char *scheduleName(Schedule schedule) {
+    switch (schedule) {
+        case Schedule::Static: return "static";
+        case Schedule::Dynamic: return "dynamic";
+        case Schedule::Guided: return "guided";
+        case Schedule::Tiles: return "tiles";
+        case Schedule::WorkStealing: return "stealing";
+        case Schedule::Auto: return "auto";
+    }
+    return "unknown";
+}
+
+// Function to parse a schedule name given on the command line
+inline bool parseSchedule(const std::string &name, Schedule &schedule) {
+    const Schedule all[] = {Schedule::Static, Schedule::Dynamic, Schedule::Guided,
+                            Schedule::Tiles, Schedule::WorkStealing, Schedule::Auto};
+    for (Schedule candidate : all) {
+        if (name == scheduleName(candidate)) {
+            schedule = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function to query the per-core L2 size, falling back to a common 256 KB
+inline long l2CacheBytes() {
+    long bytes = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return bytes > 0 ? bytes : 256 * 1024;
+}
+
+// Function to fill in every field left at 0 so a chunk carries enough pixels
+// to amortize its scheduling cost
+inline SchedulerConfig resolveConfig(SchedulerConfig config, int width, int height) {
+    if (config.numThreads <= 0) config.numThreads = omp_get_num_procs();
+    if (config.tileWidth <= 0) config.tileWidth = std::max(1, std::min(width, static_cast<int>(l2CacheBytes() / 4)));
+    if (config.chunkRows <= 0) {
+        int rowBytes = config.schedule == Schedule::Tiles ? config.tileWidth : width;
+        config.chunkRows = static_cast<int>((MIN_CHUNK_BYTES + rowBytes - 1) / std::max(1, rowBytes));
+    }
+    config.chunkRows = std::max(1, std::min(config.chunkRows, std::max(1, height)));
+    return config;
+}
+
+// Per-thread range of chunk indices for work stealing, packed as
+// (begin << 32 | end) so owner pops and thief splits are a single CAS
+struct alignas(CACHE_LINE_SIZE) StealRange {
+    std::atomic<std::uint64_t> bounds{0};
+};
+
+inline std::uint64_t packRange(std::uint32_t begin, std::uint32_t end) {
+    return (static_cast<std::uint64_t>(begin) << 32) | end;
+}
+
+// Function for the owner to take the next chunk from the front of its range
+inline bool popFront(StealRange &range, std::uint32_t &chunk) {
+    std::uint64_t current = range.bounds.load(std::memory_order_acquire);
+    while (true) {
+        std::uint32_t begin = static_cast<std::uint32_t>(current >> 32);
+        std::uint32_t end = static_cast<std::uint32_t>(current);
+        if (begin >= end) return false;
+        if (range.bounds.compare_exchange_weak(current, packRange(begin + 1, end), std::memory_order_acq_rel)) {
+            chunk = begin;
+            return true;
+        }
+    }
+}
+
+// Function for a thief to take the back half of a victim's range
+inline bool stealBack(StealRange &victim, std::uint32_t &begin, std::uint32_t &end) {
+    std::uint64_t current = victim.bounds.load(std::memory_order_acquire);
+    while (true) {
+        std::uint32_t front = static_cast<std::uint32_t>(current >> 32);
+        std::uint32_t back = static_cast<std::uint32_t>(current);
+        if (front >= back) return false;
+        std::uint32_t take = (back - front + 1) / 2;
+        if (victim.bounds.compare_exchange_weak(current, packRange(front, back - take), std::memory_order_acq_rel)) {
+            begin = back - take;
+            end = back;
+            return true;
+        }
+    }
+}
+
+// Function to run body(thread_id, chunk) over a width x height iteration space
+// using the configured policy. Static, dynamic and guided go through
+// schedule(runtime); tiles and work stealing are built on top of OpenMP threads.
+template <typename Body>
+void runSchedule(const SchedulerConfig &config, int width, int height, Body body) {
+    const int rows = config.chunkRows;
+    const int rowChunks = (height + rows - 1) / rows;
+
+    switch (config.schedule) {
+    case Schedule::Static:
+    case Schedule::Dynamic:
+    case Schedule::Guided: {
+        omp_sched_t kind = config.schedule == Schedule::Static ? omp_sched_static
+                         : config.schedule == Schedule::Dynamic ? omp_sched_dynamic : omp_sched_guided;
+        omp_set_schedule(kind, 1);
+        #pragma omp parallel for num_threads(config.numThreads) schedule(runtime)
+        for (int c = 0; c < rowChunks; c++) {
+            body(omp_get_thread_num(), LoopChunk{c * rows, std::min(height, (c + 1) * rows), 0, width});
+        }
+        break;
+    }
+    case Schedule::Tiles: {
+        const int cols = config.tileWidth;
+        const int colTiles = (width + cols - 1) / cols;
+        #pragma omp parallel for num_threads(config.numThreads) schedule(dynamic) collapse(2)
+        for (int ty = 0; ty < rowChunks; ty++) {
+            for (int tx = 0; tx < colTiles; tx++) {
+                body(omp_get_thread_num(), LoopChunk{ty * rows, std::min(height, (ty + 1) * rows),
+                                                     tx * cols, std::min(width, (tx + 1) * cols)});
+            }
+        }
+        break;
+    }
+    case Schedule::WorkStealing:
+    case Schedule::Auto: { // Auto is normally resolved by autoTuneSchedule first
+        std::vector<StealRange> ranges(config.numThreads);
+        #pragma omp parallel num_threads(config.numThreads)
+        {
+            const int threads = omp_get_num_threads();
+            const int thread_id = omp_get_thread_num();
+            // Start from a contiguous static split so the common case keeps locality
+            ranges[thread_id].bounds.store(packRange(static_cast<std::uint32_t>(static_cast<long>(rowChunks) * thread_id / threads),
+                                                     static_cast<std::uint32_t>(static_cast<long>(rowChunks) * (thread_id + 1) / threads)));
+            #pragma omp barrier
+
+            std::uint32_t chunk, begin, end;
+            while (true) {
+                while (popFront(ranges[thread_id], chunk)) {
+                    int row = static_cast<int>(chunk) * rows;
+                    body(thread_id, LoopChunk{row, std::min(height, row + rows), 0, width});
+                }
+                bool stole = false;
+                for (int step = 1; step < threads && !stole; step++) {
+                    int victim = (thread_id + step) % threads;
+                    if (stealBack(ranges[victim], begin, end)) {
+                        ranges[thread_id].bounds.store(packRange(begin, end), std::memory_order_release);
+                        stole = true;
+                    }
+                }
+                if (!stole) break;
+            }
+        }
+        break;
+    }
+    }
+}
+
+// Function to pick the schedule, thread count and chunk size with a short
+// calibration. `calibrate(config, rows)` must run the real workload over the
+// first `rows` rows; the fastest candidate (best of CALIBRATION_TRIALS) wins.
+template <typename Calibrate>
+SchedulerConfig autoTuneSchedule(int width, int height, Calibrate calibrate) {
+    const int cores = omp_get_num_procs();
+    const long l2 = l2CacheBytes();
+    const int sampleRows = std::max(1, std::min(height, static_cast<int>(CALIBRATION_BYTES / std::max(1, width))));
+
+    std::vector<int> threadCounts = {cores};
+    if (cores >= 4) threadCounts.push_back(cores / 2);
+    const long chunkBytes[] = {MIN_CHUNK_BYTES, 4 * MIN_CHUNK_BYTES, l2 / 2};
+    const Schedule schedules[] = {Schedule::Static, Schedule::Dynamic, Schedule::Guided, Schedule::WorkStealing, Schedule::Tiles};
+
+    SchedulerConfig best;
+    double bestTime = -1.0;
+    for (int threads : threadCounts) {
+        for (Schedule schedule : schedules) {
+            for (long bytes : chunkBytes) {
+                SchedulerConfig candidate;
+                candidate.schedule = schedule;
+                candidate.numThreads = threads;
+                candidate = resolveConfig(candidate, width, sampleRows);
+                int rowBytes = schedule == Schedule::Tiles ? candidate.tileWidth : width;
+                candidate.chunkRows = static_cast<int>(std::max(1L, std::min<long>(sampleRows, bytes / std::max(1, rowBytes))));
+
+                double fastest = -1.0;
+                for (int trial = 0; trial < CALIBRATION_TRIALS; trial++) {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    calibrate(candidate, sampleRows);
+                    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+                    if (fastest < 0 || elapsed.count() < fastest) fastest = elapsed.count();
+                }
+                if (bestTime < 0 || fastest < bestTime) {
+                    bestTime = fastest;
+                    best = candidate;
+                }
+            }
+        }
+    }
+    // Chunk sizes were measured on the sample; clamp against the full image
+    best.chunkRows = std::min(best.chunkRows, std::max(1, height));
+    return best;
+}
+
+#endif // LOOP_SCHEDULER_H
@@ -0,0 +1,74 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A whole file mapped read-only into memory. The mapping is private, so the
+// pages come straight from the page cache with no read() copy. An empty file
+// opens with data() == nullptr and size() == 0.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    // `advice` is passed to madvise: MADV_SEQUENTIAL for streaming, MADV_RANDOM for lookups
+    bool open(const std::string &filename, int advice = MADV_SEQUENTIAL) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "ERROR: Could not open file " << filename << std::endl;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            std::cerr << "ERROR: Could not stat file " << filename << std::endl;
+            ::close(fd);
+            return false;
+        }
+        // mmap rejects a zero length, so an empty file stays unmapped
+        if (info.st_size == 0 && S_ISREG(info.st_mode)) {
+            ::close(fd);
+            opened = true;
+            return true;
+        }
+        mappingSize = static_cast<std::size_t>(info.st_size);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            mappingSize = 0;
+            std::cerr << "ERROR: Could not map file " << filename << std::endl;
+            return false;
+        }
+        madvise(mapping, mappingSize, advice);
+        opened = true;
+        return true;
+    }
+
+    void close() {
+        if (mapping != nullptr) munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+        opened = false;
+    }
+
+    const char *data() const { return static_cast<const char *>(mapping); }
+    std::size_t size() const { return mappingSize; }
+    bool isOpen() const { return opened; }
+
+private:
+    void *mapping = nullptr;
+    std::size_t mappingSize = 0;
+    bool opened = false;
+};
+
+#endif // MAPPED_FILE_H
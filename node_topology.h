@@ -0,0 +1,87 @@
+#ifndef NODE_TOPOLOGY_H
+#define NODE_TOPOLOGY_H
+
+#include <mpi.h>
+#include <cstddef>
+#include <string>
+#include "pgm_io.h"
+#include "pgm_mpiio.h"
+
+// Ranks grouped by the machine they run on. `nodeComm` holds the ranks that
+// can share memory; `leaderComm` holds one leader per node (MPI_COMM_NULL on
+// the other ranks) and is the only communicator that crosses the network.
+struct NodeTopology {
+    MPI_Comm nodeComm = MPI_COMM_NULL;
+    MPI_Comm leaderComm = MPI_COMM_NULL;
+    int nodeRank = 0, nodeSize = 1;
+    int nodeIndex = 0, numNodes = 1; // This node's position among the leaders
+};
+
+// Function to split `comm` into per-node groups. `preferredLeader` becomes
+// rank 0 of its node and of the leader communicator, so results reduced to
+// leader 0 land on it.
+inline NodeTopology splitByNode(MPI_Comm comm, int preferredLeader) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    const int key = rank == preferredLeader ? 0 : rank + 1;
+
+    NodeTopology topology;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, key, MPI_INFO_NULL, &topology.nodeComm);
+    MPI_Comm_rank(topology.nodeComm, &topology.nodeRank);
+    MPI_Comm_size(topology.nodeComm, &topology.nodeSize);
+
+    const bool leader = topology.nodeRank == 0;
+    MPI_Comm_split(comm, leader ? 0 : MPI_UNDEFINED, key, &topology.leaderComm);
+    if (leader) {
+        MPI_Comm_rank(topology.leaderComm, &topology.nodeIndex);
+        MPI_Comm_size(topology.leaderComm, &topology.numNodes);
+    }
+    int placement[2] = {topology.nodeIndex, topology.numNodes};
+    MPI_Bcast(placement, 2, MPI_INT, 0, topology.nodeComm);
+    topology.nodeIndex = placement[0];
+    topology.numNodes = placement[1];
+    return topology;
+}
+
+inline void freeNodeTopology(NodeTopology &topology) {
+    if (topology.leaderComm != MPI_COMM_NULL) MPI_Comm_free(&topology.leaderComm);
+    if (topology.nodeComm != MPI_COMM_NULL) MPI_Comm_free(&topology.nodeComm);
+}
+
+// A node's slab of the image, held once per node in an MPI-3 shared window
+struct SharedImageSlab {
+    MPI_Win window = MPI_WIN_NULL;
+    const unsigned char *pixels = nullptr; // Node slab as mapped into this rank
+    std::size_t offset = 0, length = 0;    // Node slab within the image
+};
+
+// Function to load the image once per node. The header is broadcast from
+// `root` (a leader, see splitByNode); the node slabs are read by the leaders
+// alone into a window allocated with MPI_Win_allocate_shared, which every
+// rank on the node then maps directly instead of receiving a copy.
+inline bool loadSharedSlab(const std::string &filename, int root, MPI_Comm comm, const NodeTopology &topology,
+                           PGMHeader &header, SharedImageSlab &slab) {
+    if (!broadcastPGMHeader(filename, root, comm, header)) return false;
+    slabRange(static_cast<std::size_t>(header.width) * header.height, topology.numNodes, topology.nodeIndex, slab.offset, slab.length);
+
+    const bool leader = topology.nodeRank == 0;
+    unsigned char *base = nullptr;
+    MPI_Win_allocate_shared(static_cast<MPI_Aint>(leader ? slab.length : 0), 1, MPI_INFO_NULL,
+                            topology.nodeComm, &base, &slab.window);
+    MPI_Aint windowBytes;
+    int unit;
+    MPI_Win_shared_query(slab.window, 0, &windowBytes, &unit, &base);
+    slab.pixels = base;
+
+    MPI_Win_fence(MPI_MODE_NOPRECEDE, slab.window);
+    int ok = 1;
+    if (leader) ok = readPGMRange(filename, 0, topology.leaderComm, header, slab.offset, slab.length, base);
+    MPI_Win_fence(MPI_MODE_NOSUCCEED, slab.window);
+
+    int allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    if (!allOk) MPI_Win_free(&slab.window);
+    return allOk != 0;
+}
+
+#endif // NODE_TOPOLOGY_H
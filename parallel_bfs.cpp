@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "bfs.h"
+#include "csr_graph.h"
+#include "rmat_generator.h"
+
+#define BFS_ROOTS 16      // Search keys per run, as in Graph500 (which uses 64)
+#define BFS_ROOT_SEED 2   // Seed for choosing search keys
+
+// Function to load a graph from "rmat:SCALE[:EDGE_FACTOR]", a binary .csr
+// file (mapped, no copy), a dense .adj matrix or an edge-list file
+bool loadGraph(const std::string &spec, CSRGraph &owned, MappedGraph &mapped, CSRView &graph) {
+    int scale, edgeFactor;
+    if (parseRMATSpec(spec, scale, edgeFactor)) {
+        const std::uint64_t edges = static_cast<std::uint64_t>(edgeFactor) << scale;
+        owned = buildCSR(static_cast<vertex_t>(std::uint64_t(1) << scale), 0, generateRMAT(scale, 0, edges), true);
+    } else if (spec.size() > 4 && spec.compare(spec.size() - 4, 4, ".csr") == 0) {
+        if (!mapped.open(spec)) return false;
+        if (!mapped.checkRows(0, mapped.numVertices())) {
+            std::cerr << "ERROR: " << spec << " has out-of-range offsets or targets.\n";
+            return false;
+        }
+        graph = mapped.view();
+        return true;
+    } else if (spec.size() > 4 && spec.compare(spec.size() - 4, 4, ".adj") == 0) {
+        if (!loadAdjacencyMatrix(spec, owned)) return false;
+    } else if (!loadEdgeList(spec, owned)) {
+        return false;
+    }
+    graph = owned.view();
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <rmat:SCALE[:EDGE_FACTOR]|graph.csr|matrix.adj|edge_list> [num_roots] [output_csr]" << std::endl;
+        return -1;
+    }
+    const int numRoots = std::max(1, argc > 2 ? std::atoi(argv[2]) : BFS_ROOTS);
+
+    CSRGraph owned;
+    MappedGraph mapped;
+    CSRView graph;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!loadGraph(argv[1], owned, mapped, graph)) return -1;
+    std::chrono::duration<double, std::milli> loadTime = std::chrono::high_resolution_clock::now() - start;
+    std::cout << std::fixed << std::setprecision(3)
+              << "Graph: " << graph.numVertices << " vertices, " << graph.numEdges() / 2 << " undirected edges, loaded in "
+              << loadTime.count() << " ms (" << omp_get_max_threads() << " threads).\n";
+
+    if (argc > 3) {
+        if (!writeBinaryGraph(argv[3], graph)) return -1;
+        std::cout << "Binary graph saved to " << argv[3] << ".\n";
+    }
+
+    if (graph.numVertices == 0 || graph.numEdges() == 0) {
+        std::cerr << "ERROR: Graph has no edges.\n";
+        return -1;
+    }
+
+    // Search keys are random vertices with at least one edge
+    std::mt19937_64 engine(BFS_ROOT_SEED);
+    std::vector<vertex_t> roots;
+    for (int attempt = 0; static_cast<int>(roots.size()) < numRoots && attempt < 64 * numRoots; attempt++) {
+        vertex_t candidate = static_cast<vertex_t>(engine() % graph.numVertices);
+        if (graph.degree(candidate) > 0 && std::find(roots.begin(), roots.end(), candidate) == roots.end()) roots.push_back(candidate);
+    }
+    if (roots.empty()) {
+        std::cerr << "ERROR: Graph has no edges.\n";
+        return -1;
+    }
+
+    std::vector<double> rates, times;
+    bool valid = true;
+    for (vertex_t root : roots) {
+        start = std::chrono::high_resolution_clock::now();
+        BFSResult result = parallelBFS(graph, root);
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        long long errors = checkBFSRows(graph, result.parent.data(), result.level.data(), root);
+        valid &= errors == 0;
+
+        rates.push_back(result.traversedEdges / elapsed.count());
+        times.push_back(elapsed.count() * 1000.0);
+        std::cout << "  root " << std::setw(10) << root << ": " << result.visited << " vertices, " << result.levels
+                  << " levels (" << result.bottomUpLevels << " bottom-up), " << times.back() << " ms, "
+                  << rates.back() / 1e6 << " MTEPS" << (errors == 0 ? "" : "  INVALID") << "\n";
+    }
+
+    std::sort(times.begin(), times.end());
+    std::cout << "BFS time min " << times.front() << " ms, median " << times[times.size() / 2] << " ms, max "
+              << times.back() << " ms; harmonic mean " << harmonicMean(rates) / 1e6 << " MTEPS.\n";
+    if (!valid) {
+        std::cerr << "ERROR: At least one BFS tree failed validation.\n";
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef PARALLEL_HISTOGRAM_H
+#define PARALLEL_HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "histogram.h"
+#include "loop_scheduler.h"
+#include "trace.h"
+
+// Function to histogram a width x height image with the given loop policy.
+// Each thread counts into its own padded tables; nothing is shared until the
+// merge. When a tracer is given every chunk is recorded into it.
+inline void computeHistogramScheduled(const unsigned char *image, int width, int height, std::array<int, MAX_INTENSITY> &histogram,
+                                      const SchedulerConfig &config, Tracer *tracer = nullptr) {
+    std::vector<ThreadHistogram> partials(config.numThreads);
+
+    runSchedule(config, width, height, [&](int thread_id, const LoopChunk &chunk) {
+        std::uint64_t start_ticks = tracer != nullptr ? traceClock() : 0;
+
+        for (int i = chunk.rowBegin; i < chunk.rowEnd; i++) {
+            accumulateHistogram(image + static_cast<std::size_t>(i) * width + chunk.colBegin, chunk.colEnd - chunk.colBegin, partials[thread_id]);
+        }
+
+        if (tracer != nullptr) tracer->record(thread_id, chunk.rowBegin, start_ticks, traceClock());
+    });
+
+    #pragma omp parallel num_threads(config.numThreads)
+    mergeThreadHistograms(partials, histogram);
+}
+
+#endif // PARALLEL_HISTOGRAM_H
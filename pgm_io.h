@@ -0,0 +1,254 @@
+#ifndef PGM_IO_H
+#define PGM_IO_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mapped_file.h"
+
+#define PGM_PARSE_GRAIN (1 << 20) // Minimum bytes of ASCII pixel text handed to one parser thread
+
+struct PGMHeader {
+    bool binary = false;   // P5 when true, P2 otherwise
+    int width = 0;
+    int height = 0;
+    int maxShades = 0;
+    std::size_t dataOffset = 0; // Byte offset of the first pixel
+};
+
+inline bool isPGMSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+// Function to skip whitespace and '#' comments between header fields
+inline const char *skipPGMSpace(const char *pos, const char *end) {
+    while (pos < end) {
+        if (isPGMSpace(*pos)) {
+            pos++;
+        } else if (*pos == '#') {
+            while (pos < end && *pos != '\n') pos++;
+        } else {
+            break;
+        }
+    }
+    return pos;
+}
+
+// Function to parse the magic number, dimensions and maxval of a P2/P5 file.
+// `quiet` suppresses the error messages, for callers probing a partial header;
+// `truncated`, if given, is set when the parse failed only because it ran off
+// `end`, so a longer read might still succeed.
+inline bool parsePGMHeader(const char *begin, const char *end, PGMHeader &header, bool quiet = false,
+                           bool *truncated = nullptr) {
+    // A failure that ran off `end` is reported as truncated instead of printed
+    auto fail = [&](bool ranOut, const char *message) {
+        if (truncated) *truncated = ranOut;
+        if (!quiet && !(ranOut && truncated)) std::cerr << message;
+        return false;
+    };
+    if (truncated) *truncated = false;
+    if (end - begin < 2 || begin[0] != 'P' || (begin[1] != '2' && begin[1] != '5')) {
+        return fail(end - begin < 2 && (begin == end || begin[0] == 'P'),
+                    "ERROR: Input image is not a valid PGM (P2 or P5) image.\n");
+    }
+    header.binary = begin[1] == '5';
+
+    const char *pos = begin + 2;
+    int *fields[] = {&header.width, &header.height, &header.maxShades};
+    for (int *field : fields) {
+        pos = skipPGMSpace(pos, end);
+        auto result = std::from_chars(pos, end, *field);
+        if (result.ec != std::errc() || *field <= 0) return fail(pos >= end, "ERROR: Malformed PGM header.\n");
+        pos = result.ptr;
+    }
+    if (header.maxShades > 65535) {
+        if (!quiet) std::cerr << "ERROR: PGM maxval " << header.maxShades << " is out of range.\n";
+        return false;
+    }
+
+    // Exactly one whitespace byte separates the header from binary data
+    if (pos >= end || !isPGMSpace(*pos)) return fail(pos >= end, "ERROR: Malformed PGM header.\n");
+    header.dataOffset = static_cast<std::size_t>(pos + 1 - begin);
+    return true;
+}
+
+// Function to map a sample onto the 0..255 range used by the histogram kernels.
+// Samples above maxval are clamped to it, so a bad P2 value cannot wrap.
+inline unsigned char scaleToByte(unsigned int value, int maxShades) {
+    if (value > static_cast<unsigned int>(maxShades)) value = maxShades;
+    if (maxShades <= 255) return static_cast<unsigned char>(value);
+    return static_cast<unsigned char>((value * 255u + maxShades / 2) / maxShades);
+}
+
+// Function to split [begin, end) into `parts` ranges that never cut a number
+inline std::vector<const char *> splitOnWhitespace(const char *begin, const char *end, int parts) {
+    std::vector<const char *> bounds(parts + 1);
+    bounds[0] = begin;
+    bounds[parts] = end;
+    for (int t = 1; t < parts; t++) {
+        const char *pos = std::max(bounds[t - 1], begin + (end - begin) * t / parts);
+        while (pos < end && !isPGMSpace(*pos)) pos++;
+        bounds[t] = pos;
+    }
+    return bounds;
+}
+
+// Function to count the whitespace-separated tokens in a byte range
+inline std::size_t countTokens(const char *pos, const char *end) {
+    std::size_t tokens = 0;
+    bool inToken = false;
+    for (; pos < end; pos++) {
+        bool space = isPGMSpace(*pos);
+        tokens += (!space && !inToken);
+        inToken = !space;
+    }
+    return tokens;
+}
+
+// Function to parse ASCII (P2) pixel text with one std::from_chars pass per
+// thread. A first pass counts the numbers in each chunk so every thread knows
+// where its output starts; the second pass writes straight into `out`.
+inline bool parseASCIIPixels(const char *begin, const char *end, int maxShades, unsigned char *out, std::size_t count) {
+    int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int parts = static_cast<int>(std::min<std::size_t>(hardware, (end - begin) / PGM_PARSE_GRAIN + 1));
+    std::vector<const char *> bounds = splitOnWhitespace(begin, end, parts);
+
+    std::vector<std::size_t> offsets(parts + 1, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < parts; t++) {
+        workers.emplace_back([&, t] { offsets[t + 1] = countTokens(bounds[t], bounds[t + 1]); });
+    }
+    for (std::thread &worker : workers) worker.join();
+    for (int t = 0; t < parts; t++) offsets[t + 1] += offsets[t];
+    if (offsets[parts] < count) {
+        std::cerr << "ERROR: PGM has " << offsets[parts] << " pixels, expected " << count << ".\n";
+        return false;
+    }
+
+    std::vector<char> failed(parts, 0);
+    workers.clear();
+    for (int t = 0; t < parts; t++) {
+        workers.emplace_back([&, t] {
+            const char *pos = bounds[t];
+            const char *stop = bounds[t + 1];
+            for (std::size_t i = offsets[t]; i < std::min(offsets[t + 1], count); i++) {
+                while (isPGMSpace(*pos)) pos++;
+                unsigned int value = 0;
+                auto result = std::from_chars(pos, stop, value);
+                if (result.ec != std::errc()) { failed[t] = 1; return; }
+                out[i] = scaleToByte(value, maxShades);
+                pos = result.ptr;
+            }
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+        std::cerr << "ERROR: Non-numeric pixel value in PGM.\n";
+        return false;
+    }
+    return true;
+}
+
+// Function to decode a complete PGM file held in memory. On success `pixels`
+// points either into [begin, end) (8-bit P5, no copy) or into `decoded`.
+inline bool decodePGM(const char *begin, const char *end, PGMHeader &header,
+                      std::vector<unsigned char> &decoded, const unsigned char *&pixels) {
+    if (!parsePGMHeader(begin, end, header)) return false;
+
+    std::size_t count = static_cast<std::size_t>(header.width) * header.height;
+    const char *data = begin + header.dataOffset;
+    decoded.clear();
+    if (!header.binary) {
+        decoded.resize(count);
+        if (!parseASCIIPixels(data, end, header.maxShades, decoded.data(), count)) return false;
+        pixels = decoded.data();
+        return true;
+    }
+
+    std::size_t bytesPerSample = header.maxShades > 255 ? 2 : 1;
+    if (static_cast<std::size_t>(end - data) < count * bytesPerSample) {
+        std::cerr << "ERROR: PGM pixel data is truncated.\n";
+        return false;
+    }
+    if (bytesPerSample == 1) {
+        pixels = reinterpret_cast<const unsigned char *>(data);
+        return true;
+    }
+
+    // 16-bit samples are big-endian; reduce them to the 8-bit range
+    decoded.resize(count);
+    const unsigned char *samples = reinterpret_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < count; i++) {
+        unsigned int value = (static_cast<unsigned int>(samples[2 * i]) << 8) | samples[2 * i + 1];
+        decoded[i] = scaleToByte(value, header.maxShades);
+    }
+    pixels = decoded.data();
+    return true;
+}
+
+// A PGM image backed by a read-only memory mapping of the file. For 8-bit P5
+// input pixels() points straight into the mapping, so nothing is copied;
+// 16-bit P5 and ASCII P2 input is decoded once into an owned buffer.
+class PGMImage {
+public:
+    PGMImage() = default;
+    PGMImage(const PGMImage &) = delete;
+    PGMImage &operator=(const PGMImage &) = delete;
+    ~PGMImage() { release(); }
+
+    bool open(const std::string &filename) {
+        release();
+        if (!file.open(filename)) return false;
+        if (!decodePGM(file.data(), file.data() + file.size(), header, decoded, pixelData)) { release(); return false; }
+        return true;
+    }
+
+    const unsigned char *pixels() const { return pixelData; }
+    std::size_t pixelCount() const { return static_cast<std::size_t>(header.width) * header.height; }
+    int width() const { return header.width; }
+    int height() const { return header.height; }
+    int maxShades() const { return header.maxShades; }
+    bool zeroCopy() const { return pixelData != nullptr && decoded.empty(); }
+
+private:
+    void release() {
+        file.close();
+        pixelData = nullptr;
+        decoded.clear();
+        header = PGMHeader();
+    }
+
+    MappedFile file;
+    const unsigned char *pixelData = nullptr;
+    std::vector<unsigned char> decoded;
+    PGMHeader header;
+};
+
+// Function to read a PGM file (P2 or P5) into an owned pixel vector
+inline std::vector<unsigned char> readPGM(const std::string &filename, int &width, int &height) {
+    PGMImage image;
+    if (!image.open(filename)) return {};
+    width = image.width();
+    height = image.height();
+    return std::vector<unsigned char>(image.pixels(), image.pixels() + image.pixelCount());
+}
+
+// Function to write 8-bit pixels as a binary (P5) PGM file
+inline bool writePGM(const std::string &filename, const unsigned char *pixels, int width, int height) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open output file " << filename << std::endl;
+        return false;
+    }
+    file << "P5\n" << width << " " << height << "\n255\n";
+    file.write(reinterpret_cast<const char *>(pixels), static_cast<std::streamsize>(width) * height);
+    return static_cast<bool>(file);
+}
+
+#endif // PGM_IO_H
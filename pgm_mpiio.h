@@ -0,0 +1,288 @@
+#ifndef PGM_MPIIO_H
+#define PGM_MPIIO_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "pgm_io.h"
+
+#define PGM_HEADER_PROBE 4096          // Bytes the root reads first to find the header
+#define MPIIO_MAX_TRANSFER (1 << 30)   // Largest single read/write handed to MPI-IO
+
+// Function to split `count` items over `size` ranks; the first count % size
+// ranks get one extra, so nothing is dropped
+inline void slabRange(std::size_t count, int size, int rank, std::size_t &offset, std::size_t &length) {
+    std::size_t base = count / size;
+    std::size_t extra = count % size;
+    std::size_t r = static_cast<std::size_t>(rank);
+    offset = r * base + std::min(r, extra);
+    length = base + (r < extra ? 1 : 0);
+}
+
+// Function for the root to read and parse just the header, then share it.
+// Returns false on every rank if the file is unusable.
+inline bool broadcastPGMHeader(const std::string &filename, int root, MPI_Comm comm, PGMHeader &header) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    long long fields[5] = {0, 0, 0, 0, 0}; // ok, binary, width, height, maxShades; dataOffset sent below
+    long long dataOffset = 0;
+
+    if (rank == root) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        std::vector<char> probe;
+        bool ok = false, truncated = true;
+        const std::size_t fileBytes = file.is_open() ? static_cast<std::size_t>(file.tellg()) : 0;
+        // Headers with long comment blocks may need more than one probe; only a
+        // parse that ran off the end of the probe is worth a longer read
+        for (std::size_t bytes = PGM_HEADER_PROBE; file.is_open() && !ok && truncated; bytes *= 4) {
+            bytes = std::min(bytes, fileBytes);
+            probe.resize(bytes);
+            file.clear();
+            file.seekg(0);
+            file.read(probe.data(), static_cast<std::streamsize>(bytes));
+            probe.resize(static_cast<std::size_t>(file.gcount()));
+            ok = parsePGMHeader(probe.data(), probe.data() + probe.size(), header, true, &truncated);
+            if (bytes == fileBytes) break; // Whole file seen; another probe cannot help
+        }
+        if (!file.is_open()) std::cerr << "ERROR: Could not open file " << filename << std::endl;
+        else if (!ok) parsePGMHeader(probe.data(), probe.data() + probe.size(), header); // Report why the last probe failed
+        fields[0] = ok;
+        fields[1] = header.binary;
+        fields[2] = header.width;
+        fields[3] = header.height;
+        fields[4] = header.maxShades;
+        dataOffset = static_cast<long long>(header.dataOffset);
+    }
+    MPI_Bcast(fields, 5, MPI_LONG_LONG, root, comm);
+    MPI_Bcast(&dataOffset, 1, MPI_LONG_LONG, root, comm);
+
+    header.binary = fields[1] != 0;
+    header.width = static_cast<int>(fields[2]);
+    header.height = static_cast<int>(fields[3]);
+    header.maxShades = static_cast<int>(fields[4]);
+    header.dataOffset = static_cast<std::size_t>(dataOffset);
+    return fields[0] != 0;
+}
+
+// Function to move `bytes` bytes at `offset` with collective MPI-IO calls.
+// Large transfers are split into rounds; every rank runs the same number of
+// rounds so the collective calls stay matched even when some ranks have less
+// data. `transfer(fileOffset, bufferOffset, count, status)` issues one call.
+template <typename Transfer>
+inline bool transferAtAll(MPI_Offset offset, std::size_t bytes, MPI_Comm comm, Transfer transfer) {
+    unsigned long long mine = bytes, largest = 0;
+    MPI_Allreduce(&mine, &largest, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, comm);
+    const unsigned long long rounds = (largest + MPIIO_MAX_TRANSFER - 1) / MPIIO_MAX_TRANSFER;
+
+    int ok = 1;
+    for (unsigned long long round = 0; round < rounds; round++) {
+        std::size_t done = static_cast<std::size_t>(round) * MPIIO_MAX_TRANSFER;
+        int chunk = static_cast<int>(bytes > done ? std::min<std::size_t>(bytes - done, MPIIO_MAX_TRANSFER) : 0);
+        MPI_Status status;
+        if (transfer(offset + static_cast<MPI_Offset>(done), std::min(done, bytes), chunk, &status) != MPI_SUCCESS) ok = 0;
+        int moved = 0;
+        MPI_Get_count(&status, MPI_BYTE, &moved);
+        if (moved != chunk) ok = 0;
+    }
+    int allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    return allOk != 0;
+}
+
+inline bool readAtAll(MPI_File file, MPI_Offset offset, char *buffer, std::size_t bytes, MPI_Comm comm) {
+    return transferAtAll(offset, bytes, comm, [&](MPI_Offset at, std::size_t from, int count, MPI_Status *status) {
+        return MPI_File_read_at_all(file, at, buffer + from, count, MPI_BYTE, status);
+    });
+}
+
+inline bool writeAtAll(MPI_File file, MPI_Offset offset, const char *buffer, std::size_t bytes, MPI_Comm comm) {
+    return transferAtAll(offset, bytes, comm, [&](MPI_Offset at, std::size_t from, int count, MPI_Status *status) {
+        return MPI_File_write_at_all(file, at, buffer + from, count, MPI_BYTE, status);
+    });
+}
+
+// Function to load pixels [offset, offset + length) of an image whose header
+// every rank already holds into `dest`. Binary P5 is read directly by every
+// rank with MPI_File_read_at_all at its computed offset. ASCII P2 cannot be
+// addressed by byte offset, so the root parses it and scatters the ranges.
+inline bool readPGMRange(const std::string &filename, int root, MPI_Comm comm, const PGMHeader &header,
+                         std::size_t offset, std::size_t length, unsigned char *dest) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const std::size_t count = static_cast<std::size_t>(header.width) * header.height;
+
+    if (!header.binary) {
+        int range[2] = {static_cast<int>(offset), static_cast<int>(length)};
+        std::vector<int> ranges(rank == root ? 2 * size : 0), counts(size), displs(size);
+        MPI_Gather(range, 2, MPI_INT, ranges.data(), 2, MPI_INT, root, comm);
+        for (int r = 0; rank == root && r < size; r++) {
+            displs[r] = ranges[2 * r];
+            counts[r] = ranges[2 * r + 1];
+        }
+        std::vector<unsigned char> image;
+        int ok = 1;
+        if (rank == root) {
+            int width, height;
+            image = readPGM(filename, width, height);
+            ok = image.size() == count;
+        }
+        MPI_Bcast(&ok, 1, MPI_INT, root, comm);
+        if (!ok) return false;
+        MPI_Scatterv(image.data(), counts.data(), displs.data(), MPI_UNSIGNED_CHAR,
+                     dest, static_cast<int>(length), MPI_UNSIGNED_CHAR, root, comm);
+        return true;
+    }
+
+    MPI_File file;
+    if (MPI_File_open(comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+        if (rank == root) std::cerr << "ERROR: MPI-IO could not open " << filename << std::endl;
+        return false;
+    }
+    const std::size_t bytesPerSample = header.maxShades > 255 ? 2 : 1;
+    const MPI_Offset at = static_cast<MPI_Offset>(header.dataOffset + offset * bytesPerSample);
+    bool ok;
+    if (bytesPerSample == 1) {
+        ok = readAtAll(file, at, reinterpret_cast<char *>(dest), length, comm);
+    } else {
+        std::vector<unsigned char> samples(2 * length);
+        ok = readAtAll(file, at, reinterpret_cast<char *>(samples.data()), samples.size(), comm);
+        for (std::size_t i = 0; ok && i < length; i++) {
+            dest[i] = scaleToByte((static_cast<unsigned int>(samples[2 * i]) << 8) | samples[2 * i + 1], header.maxShades);
+        }
+    }
+    MPI_File_close(&file);
+    if (!ok && rank == root) std::cerr << "ERROR: PGM pixel data is truncated.\n";
+    return ok;
+}
+
+// Function to load this rank's slab of a PGM image; only the header goes
+// through the root. On return `slab` holds pixels [slabOffset, slabOffset + slab.size()).
+inline bool readPGMSlab(const std::string &filename, int root, MPI_Comm comm, PGMHeader &header,
+                        std::vector<unsigned char> &slab, std::size_t &slabOffset) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    if (!broadcastPGMHeader(filename, root, comm, header)) return false;
+
+    std::size_t length;
+    slabRange(static_cast<std::size_t>(header.width) * header.height, size, rank, slabOffset, length);
+    slab.resize(length);
+    return readPGMRange(filename, root, comm, header, slabOffset, length, slab.data());
+}
+
+// Function to build a 2D subarray datatype of unsigned bytes
+inline MPI_Datatype byteSubarray(int fullRows, int fullCols, int rows, int cols, int rowStart, int colStart) {
+    int sizes[2] = {fullRows, fullCols};
+    int subsizes[2] = {rows, cols};
+    int starts[2] = {rowStart, colStart};
+    MPI_Datatype type;
+    MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_UNSIGNED_CHAR, &type);
+    MPI_Type_commit(&type);
+    return type;
+}
+
+// Function to load a rows x cols block at (rowBegin, colBegin) of the image
+// into the interior of a buffer padded by `pad` pixels on every side, given a
+// header already shared by broadcastPGMHeader. 8-bit
+// P5 is read with one collective MPI-IO call through a subarray file view,
+// straight into the padded buffer; other formats are decoded by each rank
+// from its own mapping of the (shared) file.
+inline bool readPGMBlock(const std::string &filename, MPI_Comm comm, const PGMHeader &header,
+                         int rowBegin, int colBegin, int rows, int cols, int pad, unsigned char *buffer) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    const int stride = cols + 2 * pad;
+
+    if (!header.binary || header.maxShades > 255) {
+        PGMImage image;
+        int ok = image.open(filename), allOk = 0;
+        MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+        if (!allOk) return false;
+        for (int r = 0; r < rows; r++) {
+            const unsigned char *row = image.pixels() + static_cast<std::size_t>(rowBegin + r) * header.width + colBegin;
+            std::copy(row, row + cols, buffer + static_cast<std::size_t>(pad + r) * stride + pad);
+        }
+        return true;
+    }
+
+    MPI_File file;
+    if (MPI_File_open(comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+        if (rank == 0) std::cerr << "ERROR: MPI-IO could not open " << filename << std::endl;
+        return false;
+    }
+    MPI_Datatype fileType = byteSubarray(header.height, header.width, rows, cols, rowBegin, colBegin);
+    MPI_Datatype memoryType = byteSubarray(rows + 2 * pad, stride, rows, cols, pad, pad);
+    char native[] = "native";
+    MPI_File_set_view(file, static_cast<MPI_Offset>(header.dataOffset), MPI_UNSIGNED_CHAR, fileType, native, MPI_INFO_NULL);
+    int ok = MPI_File_read_all(file, buffer, 1, memoryType, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    int allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    MPI_Type_free(&fileType);
+    MPI_Type_free(&memoryType);
+    MPI_File_close(&file);
+    return allOk != 0;
+}
+
+// Function to create an 8-bit P5 file collectively, sized for the pixels,
+// with the header written by rank 0. `headerBytes` is where the pixels start.
+inline bool openPGMForWrite(const std::string &filename, MPI_Comm comm, int width, int height,
+                            MPI_File &file, std::size_t &headerBytes) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    const std::string header = "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    headerBytes = header.size();
+
+    if (MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+        if (rank == 0) std::cerr << "ERROR: MPI-IO could not create " << filename << std::endl;
+        return false;
+    }
+    MPI_File_set_size(file, static_cast<MPI_Offset>(header.size() + static_cast<std::size_t>(width) * height));
+    int ok = 1;
+    if (rank == 0) {
+        ok = MPI_File_write_at(file, 0, header.data(), static_cast<int>(header.size()), MPI_CHAR, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    }
+    int allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    if (!allOk) MPI_File_close(&file);
+    return allOk != 0;
+}
+
+// Function to write every rank's slab of pixels [slabOffset, slabOffset +
+// count) into one P5 file with collective MPI_File_write_at_all calls
+inline bool writePGMSlab(const std::string &filename, MPI_Comm comm, int width, int height,
+                         const unsigned char *slab, std::size_t count, std::size_t slabOffset) {
+    MPI_File file;
+    std::size_t headerBytes;
+    if (!openPGMForWrite(filename, comm, width, height, file, headerBytes)) return false;
+    bool ok = writeAtAll(file, static_cast<MPI_Offset>(headerBytes + slabOffset), reinterpret_cast<const char *>(slab), count, comm);
+    MPI_File_close(&file);
+    return ok;
+}
+
+// Function to write every rank's block into one P5 file with a single
+// collective call through a subarray file view. The blocks are taken from the
+// interior of each rank's padded buffer without an intermediate copy.
+inline bool writePGMBlock(const std::string &filename, MPI_Comm comm, int width, int height,
+                          int rowBegin, int colBegin, int rows, int cols, int pad, const unsigned char *buffer) {
+    MPI_File file;
+    std::size_t headerBytes;
+    if (!openPGMForWrite(filename, comm, width, height, file, headerBytes)) return false;
+
+    MPI_Datatype fileType = byteSubarray(height, width, rows, cols, rowBegin, colBegin);
+    MPI_Datatype memoryType = byteSubarray(rows + 2 * pad, cols + 2 * pad, rows, cols, pad, pad);
+    char native[] = "native";
+    MPI_File_set_view(file, static_cast<MPI_Offset>(headerBytes), MPI_UNSIGNED_CHAR, fileType, native, MPI_INFO_NULL);
+    int ok = MPI_File_write_all(file, buffer, 1, memoryType, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    int allOk = 0;
+    MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, comm);
+    MPI_Type_free(&fileType);
+    MPI_Type_free(&memoryType);
+    MPI_File_close(&file);
+    return allOk != 0;
+}
+
+#endif // PGM_MPIIO_H
@@ -0,0 +1,188 @@
+#ifndef QUERY_AUTOMATON_H
+#define QUERY_AUTOMATON_H
+
+#include <mpi.h>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "corpus_reader.h"
+
+#define QUERY_ALPHABET ('z' - 'A' + 1) // Word bytes; any other byte sends the automaton back to the root
+
+// Aho-Corasick automaton over a set of query terms. Trie nodes are numbered
+// in BFS order, so each node's parent and failure target come before it.
+// Only `parent` and `label` per node and one terminal node per term travel
+// between ranks; every rank expands them into the dense transition table.
+struct QueryAutomaton {
+    std::vector<std::int32_t> parent;      // Per node; -1 for the root
+    std::vector<unsigned char> label;      // Byte class on the edge from the parent
+    std::vector<std::int32_t> terminal;    // Per term; -1 when the term can never match
+    std::vector<std::int32_t> fail;        // Expanded on every rank
+    std::vector<std::int32_t> depth;
+    std::vector<std::int32_t> delta;       // nodes x QUERY_ALPHABET
+
+    std::size_t nodes() const { return parent.size(); }
+    std::size_t terms() const { return terminal.size(); }
+    std::int32_t step(std::int32_t state, char c) const {
+        return isWordByte(c) ? delta[static_cast<std::size_t>(state) * QUERY_ALPHABET + (static_cast<unsigned char>(c) - 'A')] : 0;
+    }
+};
+
+// Function to fill fail, depth and delta from parent and label
+inline void expandAutomaton(QueryAutomaton &automaton) {
+    const std::size_t nodes = automaton.nodes();
+    automaton.fail.assign(nodes, 0);
+    automaton.depth.assign(nodes, 0);
+    automaton.delta.assign(nodes * QUERY_ALPHABET, -1);
+    std::int32_t *delta = automaton.delta.data();
+    for (std::size_t i = 1; i < nodes; i++) delta[static_cast<std::size_t>(automaton.parent[i]) * QUERY_ALPHABET + automaton.label[i]] = static_cast<std::int32_t>(i);
+    for (int c = 0; c < QUERY_ALPHABET; c++) {
+        if (delta[c] < 0) delta[c] = 0;
+    }
+    for (std::size_t i = 1; i < nodes; i++) {
+        const std::int32_t p = automaton.parent[i];
+        automaton.depth[i] = automaton.depth[p] + 1;
+        automaton.fail[i] = p == 0 ? 0 : delta[static_cast<std::size_t>(automaton.fail[p]) * QUERY_ALPHABET + automaton.label[i]];
+        const std::int32_t *fallback = delta + static_cast<std::size_t>(automaton.fail[i]) * QUERY_ALPHABET;
+        std::int32_t *row = delta + i * QUERY_ALPHABET;
+        for (int c = 0; c < QUERY_ALPHABET; c++) {
+            if (row[c] < 0) row[c] = fallback[c];
+        }
+    }
+}
+
+// Function to build the automaton for `terms`. Terms holding a separator
+// can never match a word and get no terminal node.
+inline QueryAutomaton buildQueryAutomaton(const std::vector<std::string> &terms) {
+    // Sparse trie first, then a BFS renumbering
+    std::vector<std::vector<std::int32_t> > children(1, std::vector<std::int32_t>(QUERY_ALPHABET, -1));
+    std::vector<std::int32_t> termNode(terms.size(), -1);
+    for (std::size_t t = 0; t < terms.size(); t++) {
+        bool valid = !terms[t].empty();
+        for (char c : terms[t]) valid &= isWordByte(c);
+        if (!valid) continue;
+        std::int32_t node = 0;
+        for (char c : terms[t]) {
+            const int symbol = static_cast<unsigned char>(c) - 'A';
+            if (children[node][symbol] < 0) {
+                children[node][symbol] = static_cast<std::int32_t>(children.size());
+                children.emplace_back(QUERY_ALPHABET, -1);
+            }
+            node = children[node][symbol];
+        }
+        termNode[t] = node;
+    }
+
+    QueryAutomaton automaton;
+    std::vector<std::int32_t> order(1, 0), renumber(children.size(), 0);
+    automaton.parent.push_back(-1);
+    automaton.label.push_back(0);
+    for (std::size_t head = 0; head < order.size(); head++) {
+        for (int c = 0; c < QUERY_ALPHABET; c++) {
+            const std::int32_t child = children[order[head]][c];
+            if (child < 0) continue;
+            renumber[child] = static_cast<std::int32_t>(order.size());
+            order.push_back(child);
+            automaton.parent.push_back(static_cast<std::int32_t>(head));
+            automaton.label.push_back(static_cast<unsigned char>(c));
+        }
+    }
+    automaton.terminal.resize(terms.size());
+    for (std::size_t t = 0; t < terms.size(); t++) automaton.terminal[t] = termNode[t] < 0 ? -1 : renumber[termNode[t]];
+    expandAutomaton(automaton);
+    return automaton;
+}
+
+// Function to read query terms, one per word of the file, keeping the first
+// occurrence of each in file order
+inline bool loadQueryTerms(const std::string &filename, std::vector<std::string> &terms) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+    std::unordered_set<std::string> seen;
+    forEachWord(file.data(), file.data() + file.size(), [&](const char *word, std::size_t length) {
+        std::string term(word, length);
+        if (seen.insert(term).second) terms.push_back(term);
+    });
+    if (terms.empty()) std::cerr << "ERROR: No query terms in " << filename << std::endl;
+    return !terms.empty();
+}
+
+// Function to share the root's automaton in its compact form and expand it
+// on every other rank. `ok` is the root's verdict on its query list;
+// returns it on every rank.
+inline bool broadcastQueryAutomaton(QueryAutomaton &automaton, bool ok, int root, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    long long sizes[3] = {ok, static_cast<long long>(automaton.nodes()), static_cast<long long>(automaton.terms())};
+    MPI_Bcast(sizes, 3, MPI_LONG_LONG, root, comm);
+    if (!sizes[0]) return false;
+    if (rank != root) {
+        automaton.parent.resize(sizes[1]);
+        automaton.label.resize(sizes[1]);
+        automaton.terminal.resize(sizes[2]);
+    }
+    MPI_Bcast(automaton.parent.data(), static_cast<int>(sizes[1]), MPI_INT32_T, root, comm);
+    MPI_Bcast(automaton.label.data(), static_cast<int>(sizes[1]), MPI_UNSIGNED_CHAR, root, comm);
+    MPI_Bcast(automaton.terminal.data(), static_cast<int>(sizes[2]), MPI_INT32_T, root, comm);
+    if (rank != root) expandAutomaton(automaton);
+    return true;
+}
+
+// Per-node hit counters for one pass. Substring hits are recorded at every
+// byte and pushed down the failure links once at the end, so each byte
+// costs one table step and one increment however many terms end there.
+struct QueryHits {
+    std::vector<unsigned long long> substring;
+    std::vector<unsigned long long> whole;
+
+    explicit QueryHits(std::size_t nodes) : substring(nodes, 0), whole(nodes, 0) {}
+    explicit QueryHits(const QueryAutomaton &automaton) : QueryHits(automaton.nodes()) {}
+};
+
+// Function to add another pass's hits into `hits`, e.g. to combine threads
+inline void mergeHits(QueryHits &hits, const QueryHits &other) {
+    for (std::size_t i = 0; i < hits.substring.size(); i++) {
+        hits.substring[i] += other.substring[i];
+        hits.whole[i] += other.whole[i];
+    }
+}
+
+// Function to scan a word (substring matching) or test it (whole-word matching)
+inline void scanWord(const QueryAutomaton &automaton, const char *word, std::size_t length, bool substrings, QueryHits &hits) {
+    std::int32_t state = 0;
+    if (substrings) {
+        for (std::size_t i = 0; i < length; i++) {
+            state = automaton.step(state, word[i]);
+            hits.substring[state]++;
+        }
+    } else {
+        for (std::size_t i = 0; i < length; i++) state = automaton.step(state, word[i]);
+        if (static_cast<std::size_t>(automaton.depth[state]) == length) hits.whole[state]++;
+    }
+}
+
+// Function to scan corpus text in [begin, end)
+inline void scanText(const QueryAutomaton &automaton, const char *begin, const char *end, bool substrings, QueryHits &hits) {
+    if (substrings) {
+        std::int32_t state = 0;
+        for (const char *pos = begin; pos < end; pos++) {
+            state = automaton.step(state, *pos);
+            hits.substring[state]++;
+        }
+    } else {
+        forEachWord(begin, end, [&](const char *word, std::size_t length) { scanWord(automaton, word, length, false, hits); });
+    }
+}
+
+// Function to turn node hits into one count per term
+inline void termCounts(const QueryAutomaton &automaton, QueryHits &hits, long long *counts) {
+    for (std::size_t i = automaton.nodes() - 1; i > 0; i--) hits.substring[automaton.fail[i]] += hits.substring[i];
+    for (std::size_t t = 0; t < automaton.terms(); t++) {
+        const std::int32_t node = automaton.terminal[t];
+        counts[t] = node < 0 ? 0 : static_cast<long long>(hits.substring[node] + hits.whole[node]);
+    }
+}
+
+#endif // QUERY_AUTOMATON_H
@@ -1,60 +1,292 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <omp.h>
+#include <string>
 #include <vector>
-#include <cstdlib>
-#include <mutex>
 
-#define SET_THRESHOLD 100
-int partition(std::vector<int>& inputArray, int low, int high) {
-    int pivot = inputArray[high];
-    int i = low - 1;
-    for (int j = low; j < high; j++) {
-        if (inputArray[j] < pivot) {
-            i++;
-            std::swap(inputArray[i], inputArray[j]);
+#define SET_THRESHOLD 16384      // Ranges longer than this are sorted in their own OpenMP task
+#define INSERTION_CUTOFF 24      // Ranges this short are insertion sorted
+#define NINTHER_THRESHOLD 128    // Ranges longer than this take a ninther pivot, shorter ones a median of 3
+#define PARTIAL_INSERTION_LIMIT 8 // Moves allowed when finishing a range that partitioned without swaps
+#define PARTITION_BLOCK 64       // Keys classified per side before partition swaps any (at most 256)
+
+void insertionSort(std::vector<int>& arr, int low, int high) {
+    for (int i = low + 1; i <= high; i++) {
+        int value = arr[i];
+        int j = i - 1;
+        while (j >= low && value < arr[j]) {
+            arr[j + 1] = arr[j];
+            j--;
         }
+        arr[j + 1] = value;
     }
-    std::swap(inputArray[i + 1], inputArray[high]);
-    return i + 1;
 }
 
+// Fallback once the depth limit is hit: O(n log n) whatever the input
+void heapSort(std::vector<int>& arr, int low, int high) {
+    std::make_heap(arr.begin() + low, arr.begin() + high + 1);
+    std::sort_heap(arr.begin() + low, arr.begin() + high + 1);
+}
 
-void quicksort(std::vector<int>& arr, int low, int high) {
-    if (low < high) {
-        int pivotIndex = partition(arr, low, high);
-        if (high - low < SET_THRESHOLD) {  
-            quicksort(arr, low, pivotIndex - 1);
-            quicksort(arr, pivotIndex + 1, high);
+int medianOf3(const std::vector<int>& arr, int a, int b, int c) {
+    if (arr[a] < arr[b]) return arr[b] < arr[c] ? b : (arr[a] < arr[c] ? c : a);
+    return arr[a] < arr[c] ? a : (arr[b] < arr[c] ? c : b);
+}
+
+// Median of 3 for short ranges; Tukey's ninther (median of three medians of 3)
+// for long ones, so sorted, reversed and organ-pipe inputs still split evenly
+int choosePivot(const std::vector<int>& arr, int low, int high) {
+    int n = high - low + 1, mid = low + n / 2;
+    if (n <= NINTHER_THRESHOLD) return medianOf3(arr, low, mid, high);
+    int s = n / 8;
+    return medianOf3(arr, medianOf3(arr, low, low + s, low + 2 * s),
+                     medianOf3(arr, mid - s, mid, mid + s),
+                     medianOf3(arr, high - 2 * s, high - s, high));
+}
+
+// Function to swap `num` pairs of out-of-place keys found by partition: the
+// i-th on the left at first + left[i], the i-th on the right at last - right[i].
+// When the two lists differ in length the swaps are chained through one
+// temporary, which costs one move per key instead of three.
+void swapOffsets(int* first, int* last, const unsigned char* left, const unsigned char* right, int num, bool useSwaps) {
+    if (useSwaps) {
+        for (int i = 0; i < num; i++) std::swap(first[left[i]], *(last - right[i]));
+    } else if (num > 0) {
+        int* l = first + left[0];
+        int* r = last - right[0];
+        int tmp = *l;
+        *l = *r;
+        for (int i = 1; i < num; i++) {
+            l = first + left[i];
+            *r = *l;
+            r = last - right[i];
+            *l = *r;
+        }
+        *r = tmp;
+    }
+}
+
+// Block partition around arr[low] (Edelkamp and Weiss's BlockQuicksort, laid out as
+// in pdqsort); returns the pivot's final index. Keys < pivot end up on its left,
+// the rest on its right. Each side first records the offsets of its misplaced keys
+// for a whole block without branching on the comparisons, then the recorded pairs
+// are swapped, so random keys do not cost a mispredicted branch per element.
+// The opening scan needs no bounds check: the pivot sample left a key >= pivot
+// in the range. `swapped` reports whether the range was out of place.
+int partition(std::vector<int>& arr, int low, int high, bool& swapped) {
+    int* const base = arr.data();
+    const int pivot = base[low];
+    int* first = base + low;
+    int* last = base + high + 1;
+    while (*++first < pivot) {}
+    if (first - 1 == base + low) {
+        while (first < last && !(*--last < pivot)) {}
+    } else {
+        while (!(*--last < pivot)) {}
+    }
+    swapped = first < last;
+
+    if (swapped) {
+        std::swap(*first, *last);
+        ++first;
+        alignas(64) unsigned char offsetsLeft[PARTITION_BLOCK];
+        alignas(64) unsigned char offsetsRight[PARTITION_BLOCK];
+        int numLeft = 0, numRight = 0, startLeft = 0, startRight = 0;
+        // Classify `leftSize` keys from first and `rightSize` keys back from last into
+        // whichever offset buffers are empty, then swap as many pairs as both hold
+        auto step = [&](int leftSize, int rightSize) {
+            if (numLeft == 0) {
+                startLeft = 0;
+                for (int i = 0; i < leftSize; i++) {
+                    offsetsLeft[numLeft] = static_cast<unsigned char>(i);
+                    numLeft += !(first[i] < pivot);
+                }
+            }
+            if (numRight == 0) {
+                startRight = 0;
+                for (int i = 0; i < rightSize; i++) {
+                    offsetsRight[numRight] = static_cast<unsigned char>(i + 1);
+                    numRight += *(last - (i + 1)) < pivot;
+                }
+            }
+            int num = std::min(numLeft, numRight);
+            swapOffsets(first, last, offsetsLeft + startLeft, offsetsRight + startRight, num, numLeft == numRight);
+            numLeft -= num;
+            numRight -= num;
+            startLeft += num;
+            startRight += num;
+            if (numLeft == 0) first += leftSize;
+            if (numRight == 0) last -= rightSize;
+        };
+        while (last - first > 2 * PARTITION_BLOCK) step(PARTITION_BLOCK, PARTITION_BLOCK);
+
+        // Split what is left between the sides; a buffer still holding keys
+        // stands for a whole block that is already classified
+        int unknown = static_cast<int>(last - first) - (numLeft || numRight ? PARTITION_BLOCK : 0);
+        if (numRight) step(unknown, PARTITION_BLOCK);
+        else if (numLeft) step(PARTITION_BLOCK, unknown);
+        else step(unknown / 2, unknown - unknown / 2);
+
+        // At most one side has keys left over; move them across the boundary
+        if (numLeft) {
+            while (numLeft--) std::swap(first[offsetsLeft[startLeft + numLeft]], *--last);
+            first = last;
+        }
+        if (numRight) {
+            while (numRight--) std::swap(*(last - offsetsRight[startRight + numRight]), *first), ++first;
+        }
+    }
+
+    int pivotIndex = static_cast<int>(first - base) - 1;
+    base[low] = base[pivotIndex];
+    base[pivotIndex] = pivot;
+    return pivotIndex;
+}
+
+// Insertion sort that gives up after PARTIAL_INSERTION_LIMIT moves, for
+// ranges that are probably sorted already; returns whether it finished
+bool partialInsertionSort(std::vector<int>& arr, int low, int high) {
+    int moves = 0;
+    for (int i = low + 1; i <= high; i++) {
+        int value = arr[i];
+        int j = i - 1;
+        while (j >= low && value < arr[j]) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        arr[j + 1] = value;
+        moves += i - 1 - j;
+        if (moves > PARTIAL_INSERTION_LIMIT) return false;
+    }
+    return true;
+}
+
+// Dutch-flag partition around arr[low]: afterwards [low, lt) < pivot,
+// [lt, gt] == pivot and (gt, high] > pivot
+void partition3(std::vector<int>& arr, int low, int high, int& lt, int& gt) {
+    int pivot = arr[low];
+    int i = low + 1;
+    lt = low;
+    gt = high;
+    while (i <= gt) {
+        if (arr[i] < pivot) std::swap(arr[lt++], arr[i++]);
+        else if (pivot < arr[i]) std::swap(arr[i], arr[gt--]);
+        else i++;
+    }
+}
+
+// Introsort on [low, high]. `bounded` says arr[low - 1] is a previous pivot,
+// no greater than any key in the range. When the new pivot equals it, the
+// range is full of that key, and a 3-way partition sets every copy aside at
+// once, so duplicate-heavy input costs O(n * distinct keys). The smaller
+// side is recursed into (as a task above SET_THRESHOLD) and the larger one
+// looped on, which keeps the stack at O(log n).
+void introsort(std::vector<int>& arr, int low, int high, int depthLimit, bool bounded) {
+    while (high - low + 1 > INSERTION_CUTOFF) {
+        if (depthLimit-- == 0) {
+            heapSort(arr, low, high);
             return;
-        } if (omp_get_level() < omp_get_max_active_levels()) {
-            #pragma omp task shared(arr), firstprivate(low, pivotIndex)
-            quicksort(arr, low, pivotIndex - 1);
-            #pragma omp task shared(arr), firstprivate(high, pivotIndex)
-            quicksort(arr, pivotIndex + 1, high);
-            #pragma omp taskwait 
+        }
+        std::swap(arr[low], arr[choosePivot(arr, low, high)]);
+        if (bounded && !(arr[low - 1] < arr[low])) {
+            int lt, gt;
+            partition3(arr, low, high, lt, gt);
+            low = gt + 1;
+            continue;
+        }
+        bool swapped;
+        int pivotIndex = partition(arr, low, high, swapped);
+        // Nothing moved, so the input may be sorted here: try to finish both sides cheaply
+        if (!swapped && partialInsertionSort(arr, low, pivotIndex - 1) && partialInsertionSort(arr, pivotIndex + 1, high)) return;
+
+        int smallLow = low, smallHigh = pivotIndex - 1;
+        bool smallBounded = bounded;
+        if (pivotIndex - low > high - pivotIndex) {
+            smallLow = pivotIndex + 1;
+            smallHigh = high;
+            smallBounded = true;
+            high = pivotIndex - 1;
         } else {
-            quicksort(arr, low, pivotIndex - 1);
-            quicksort(arr, pivotIndex + 1, high);
+            low = pivotIndex + 1;
+            bounded = true;
+        }
+        if (smallHigh - smallLow + 1 > SET_THRESHOLD) {
+            #pragma omp task shared(arr) firstprivate(smallLow, smallHigh, depthLimit, smallBounded)
+            introsort(arr, smallLow, smallHigh, depthLimit, smallBounded);
+        } else {
+            introsort(arr, smallLow, smallHigh, depthLimit, smallBounded);
         }
     }
+    insertionSort(arr, low, high);
 }
 
-
-int main() {
-    const int SIZE = 10000;
-    std::vector<int> numbers(SIZE);
-    for (int i = 0; i < SIZE; ++i) {
-        numbers[i] = std::rand() % 100000;
+// Sorts arr[low..high]. Inside a parallel region the big ranges become tasks
+// for the team; the call returns once all of them are done.
+void quicksort(std::vector<int>& arr, int low, int high) {
+    if (low >= high) return;
+    // Reversed input is turned around in one pass; partitioning it would
+    // swap half the keys before the sorted-run check could notice
+    int run = low;
+    while (run < high && arr[run + 1] < arr[run]) run++;
+    if (run == high) {
+        std::reverse(arr.begin() + low, arr.begin() + high + 1);
+        return;
     }
+    int depthLimit = 0;
+    for (int n = high - low + 1; n > 1; n >>= 1) depthLimit += 2; // 2 * log2(n)
+    #pragma omp taskgroup
+    introsort(arr, low, high, depthLimit, false);
+}
+
+double timeSort(std::vector<int>& arr, const std::function<void(std::vector<int>&)>& sort) {
     auto start = std::chrono::high_resolution_clock::now();
-    #pragma omp parallel
-    {
-        #pragma omp single 
-        quicksort(numbers, 0, SIZE - 1);
-    }
+    sort(arr);
     auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double, std::milli> diff = end-start;
-    std::cout << "Quicksort executed in: " << diff.count() << " ms." << std::endl;
-    return 0;
+    std::chrono::duration<double, std::milli> diff = end - start;
+    return diff.count();
+}
+
+int main(int argc, char* argv[]) {
+    const int SIZE = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    if (SIZE < 1) {
+        std::cout << "ERROR: Size must be positive." << std::endl;
+        return 1;
+    }
+
+    // Inputs that make a naive quicksort quadratic, next to the original random keys
+    const std::vector<std::pair<std::string, std::function<int(int)> > > inputs = {
+        {"random % 100000", [](int) { return std::rand() % 100000; }},
+        {"random", [](int) { return std::rand(); }},
+        {"sorted", [](int i) { return i; }},
+        {"reversed", [SIZE](int i) { return SIZE - i; }},
+        {"organ pipe", [SIZE](int i) { return std::min(i, SIZE - i); }},
+        {"few keys", [](int) { return std::rand() % 4; }},
+        {"all equal", [](int) { return 7; }},
+    };
+    std::cout << "Sorting " << SIZE << " ints with " << omp_get_max_threads() << " threads." << std::endl;
+    bool correct = true;
+    for (const auto& input : inputs) {
+        std::vector<int> numbers(SIZE);
+        for (int i = 0; i < SIZE; ++i) numbers[i] = input.second(i);
+        std::vector<int> parallel(numbers), serial(numbers), reference(numbers);
+
+        double parallelTime = timeSort(parallel, [](std::vector<int>& arr) {
+            #pragma omp parallel
+            {
+                #pragma omp single
+                quicksort(arr, 0, static_cast<int>(arr.size()) - 1);
+            }
+        });
+        double serialTime = timeSort(serial, [](std::vector<int>& arr) { quicksort(arr, 0, static_cast<int>(arr.size()) - 1); });
+        double referenceTime = timeSort(reference, [](std::vector<int>& arr) { std::sort(arr.begin(), arr.end()); });
+        correct &= parallel == reference && serial == reference;
+
+        std::cout << "Quicksort executed in: " << parallelTime << " ms (" << serialTime << " ms on one thread, std::sort "
+                  << referenceTime << " ms) on " << input.first << " keys." << std::endl;
+    }
+    if (!correct) std::cout << "ERROR: Quicksort output differs from std::sort." << std::endl;
+    return correct ? 0 : 1;
 }
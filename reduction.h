@@ -0,0 +1,233 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define REDUCE_TAG 20
+#define PIPELINE_SEGMENT 8192 // Elements per message in the pipelined ring
+
+// Sum reductions of a count vector to one root. Every algorithm works in
+// place: `counts` holds this rank's values on entry, and the root's holds
+// the totals on return. Other ranks' buffers are left partially summed.
+enum class ReduceAlgorithm { Library, Ring, Binomial, RecursiveDoubling, Rabenseifner, PipelinedRing, Nonblocking };
+
+inline const char *reductionName(ReduceAlgorithm algorithm) {
+    switch (algorithm) {
+        case ReduceAlgorithm::Library: return "b1";
+        case ReduceAlgorithm::Ring: return "b2";
+        case ReduceAlgorithm::Binomial: return "binomial";
+        case ReduceAlgorithm::RecursiveDoubling: return "doubling";
+        case ReduceAlgorithm::Rabenseifner: return "rabenseifner";
+        case ReduceAlgorithm::PipelinedRing: return "pipeline";
+        case ReduceAlgorithm::Nonblocking: return "ireduce";
+    }
+    return "unknown";
+}
+
+inline bool parseReduction(const std::string &name, ReduceAlgorithm &algorithm) {
+    for (ReduceAlgorithm candidate : {ReduceAlgorithm::Library, ReduceAlgorithm::Ring, ReduceAlgorithm::Binomial, ReduceAlgorithm::RecursiveDoubling,
+                                      ReduceAlgorithm::Rabenseifner, ReduceAlgorithm::PipelinedRing, ReduceAlgorithm::Nonblocking}) {
+        if (name == reductionName(candidate)) {
+            algorithm = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void addInto(long long *target, const long long *source, int count) {
+    for (int i = 0; i < count; i++) target[i] += source[i];
+}
+
+// Ranks are renumbered so the root is 0
+inline int relativeRank(int rank, int root, int size) { return (rank - root + size) % size; }
+inline int absoluteRank(int relative, int root, int size) { return (relative + root) % size; }
+
+// Serialized ring: the partial sum travels root -> 1 -> ... -> size-1 and
+// back to the root, size messages in sequence
+inline void reduceRing(long long *counts, int count, int root, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    if (size == 1) return;
+    const int v = relativeRank(rank, root, size);
+    const int next = absoluteRank((v + 1) % size, root, size), previous = absoluteRank((v + size - 1) % size, root, size);
+    std::vector<long long> received(count);
+    if (v == 0) {
+        MPI_Send(counts, count, MPI_LONG_LONG, next, REDUCE_TAG, comm);
+        MPI_Recv(counts, count, MPI_LONG_LONG, previous, REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+        return;
+    }
+    MPI_Recv(received.data(), count, MPI_LONG_LONG, previous, REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+    addInto(counts, received.data(), count);
+    MPI_Send(counts, count, MPI_LONG_LONG, next, REDUCE_TAG, comm);
+}
+
+// Binomial tree: log2(size) rounds; in round k, ranks with bit k set hand
+// their partial sum to the rank 2^k below and drop out
+inline void reduceBinomial(long long *counts, int count, int root, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const int v = relativeRank(rank, root, size);
+    std::vector<long long> received(size > 1 ? count : 0);
+    for (int mask = 1; mask < size; mask <<= 1) {
+        if (v & mask) {
+            MPI_Send(counts, count, MPI_LONG_LONG, absoluteRank(v - mask, root, size), REDUCE_TAG, comm);
+            return;
+        }
+        if (v + mask < size) {
+            MPI_Recv(received.data(), count, MPI_LONG_LONG, absoluteRank(v + mask, root, size), REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+            addInto(counts, received.data(), count);
+        }
+    }
+}
+
+// Function to fold the ranks above the largest power of two onto the ranks
+// below it. Returns that power of two, or 0 if this rank has folded and is done.
+inline int foldToPowerOfTwo(long long *counts, int count, int v, int root, int size, MPI_Comm comm) {
+    int pof2 = 1;
+    while (pof2 * 2 <= size) pof2 *= 2;
+    if (v >= pof2) {
+        MPI_Send(counts, count, MPI_LONG_LONG, absoluteRank(v - pof2, root, size), REDUCE_TAG, comm);
+        return 0;
+    }
+    if (v + pof2 < size) {
+        std::vector<long long> received(count);
+        MPI_Recv(received.data(), count, MPI_LONG_LONG, absoluteRank(v + pof2, root, size), REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+        addInto(counts, received.data(), count);
+    }
+    return pof2;
+}
+
+// Recursive doubling: partners 2^k apart swap whole vectors and both add,
+// so after log2(size) rounds every rank (the root included) has the total.
+// Latency-optimal for short vectors; moves the full vector every round.
+inline void reduceRecursiveDoubling(long long *counts, int count, int root, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const int v = relativeRank(rank, root, size);
+    const int pof2 = foldToPowerOfTwo(counts, count, v, root, size, comm);
+    if (pof2 <= 1) return;
+    std::vector<long long> received(count);
+    for (int mask = 1; mask < pof2; mask <<= 1) {
+        const int partner = absoluteRank(v ^ mask, root, size);
+        MPI_Sendrecv(counts, count, MPI_LONG_LONG, partner, REDUCE_TAG, received.data(), count, MPI_LONG_LONG, partner, REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+        addInto(counts, received.data(), count);
+    }
+}
+
+// Rabenseifner: a reduce-scatter by recursive halving (each round swaps and
+// adds half of the remaining range), then a binomial gather of the summed
+// pieces to the root. Each rank sends about 2 * count elements in total
+// instead of count * log2(size), which wins on long vectors.
+inline void reduceRabenseifner(long long *counts, int count, int root, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const int v = relativeRank(rank, root, size);
+    const int pof2 = foldToPowerOfTwo(counts, count, v, root, size, comm);
+    if (pof2 <= 1) return;
+
+    std::vector<long long> received(count / 2 + 1);
+    std::vector<int> lows, highs; // Range held before each halving round
+    int low = 0, high = count;
+    for (int mask = pof2 / 2; mask >= 1; mask /= 2) {
+        const int partner = absoluteRank(v ^ mask, root, size);
+        const int middle = low + (high - low) / 2;
+        lows.push_back(low);
+        highs.push_back(high);
+        // The rank with the bit clear keeps the lower half
+        const int keepLow = (v & mask) ? middle : low, keepHigh = (v & mask) ? high : middle;
+        const int sendLow = (v & mask) ? low : middle, sendHigh = (v & mask) ? middle : high;
+        MPI_Sendrecv(counts + sendLow, sendHigh - sendLow, MPI_LONG_LONG, partner, REDUCE_TAG,
+                     received.data(), keepHigh - keepLow, MPI_LONG_LONG, partner, REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+        addInto(counts + keepLow, received.data(), keepHigh - keepLow);
+        low = keepLow;
+        high = keepHigh;
+    }
+
+    // Undo the halving rounds in reverse: each receiver takes its partner's half
+    for (int mask = 1, round = static_cast<int>(lows.size()) - 1; mask < pof2; mask <<= 1, round--) {
+        if (v & mask) {
+            MPI_Send(counts + low, high - low, MPI_LONG_LONG, absoluteRank(v - mask, root, size), REDUCE_TAG, comm);
+            return;
+        }
+        const int otherLow = high, otherHigh = highs[round];
+        MPI_Recv(counts + otherLow, otherHigh - otherLow, MPI_LONG_LONG, absoluteRank(v + mask, root, size), REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+        low = lows[round];
+        high = highs[round];
+    }
+}
+
+// Pipelined ring: ranks form a chain ending at the root and the vector
+// moves in PIPELINE_SEGMENT pieces, so every link is busy at once and the
+// time approaches one vector transfer plus (size - 1) segment hops
+inline void reducePipelinedRing(long long *counts, int count, int root, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const int v = relativeRank(rank, root, size);
+    std::vector<long long> received(std::min(count, PIPELINE_SEGMENT));
+    for (int start = 0; start < count; start += PIPELINE_SEGMENT) {
+        const int length = std::min(PIPELINE_SEGMENT, count - start);
+        if (v < size - 1) {
+            MPI_Recv(received.data(), length, MPI_LONG_LONG, absoluteRank(v + 1, root, size), REDUCE_TAG, comm, MPI_STATUS_IGNORE);
+            addInto(counts + start, received.data(), length);
+        }
+        if (v > 0) MPI_Send(counts + start, length, MPI_LONG_LONG, absoluteRank(v - 1, root, size), REDUCE_TAG, comm);
+    }
+}
+
+// Function to sum `counts` over all ranks into the root's buffer
+inline void reduceCounts(ReduceAlgorithm algorithm, long long *counts, int count, int root, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    switch (algorithm) {
+        case ReduceAlgorithm::Library:
+            MPI_Reduce(rank == root ? MPI_IN_PLACE : counts, counts, count, MPI_LONG_LONG, MPI_SUM, root, comm);
+            break;
+        case ReduceAlgorithm::Ring: reduceRing(counts, count, root, comm); break;
+        case ReduceAlgorithm::Binomial: reduceBinomial(counts, count, root, comm); break;
+        case ReduceAlgorithm::RecursiveDoubling: reduceRecursiveDoubling(counts, count, root, comm); break;
+        case ReduceAlgorithm::Rabenseifner: reduceRabenseifner(counts, count, root, comm); break;
+        case ReduceAlgorithm::PipelinedRing: reducePipelinedRing(counts, count, root, comm); break;
+        case ReduceAlgorithm::Nonblocking: {
+            // The request could be left open across other work; here it is waited on at once
+            MPI_Request request;
+            MPI_Ireduce(rank == root ? MPI_IN_PLACE : counts, counts, count, MPI_LONG_LONG, MPI_SUM, root, comm, &request);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+            break;
+        }
+    }
+}
+
+// Per-phase wall times, summarised as the slowest and fastest rank per
+// iteration and then the median over iterations
+struct PhaseTimer {
+    std::vector<std::vector<double> > slowest, fastest;
+
+    // Function to record one iteration's times for every phase; collective
+    void record(const std::vector<double> &times, MPI_Comm comm) {
+        std::vector<double> high(times.size()), low(times.size());
+        MPI_Allreduce(times.data(), high.data(), static_cast<int>(times.size()), MPI_DOUBLE, MPI_MAX, comm);
+        MPI_Allreduce(times.data(), low.data(), static_cast<int>(times.size()), MPI_DOUBLE, MPI_MIN, comm);
+        slowest.resize(times.size());
+        fastest.resize(times.size());
+        for (std::size_t p = 0; p < times.size(); p++) {
+            slowest[p].push_back(high[p]);
+            fastest[p].push_back(low[p]);
+        }
+    }
+
+    static double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0.0 : values[values.size() / 2];
+    }
+};
+
+#endif // REDUCTION_H
@@ -0,0 +1,71 @@
+#ifndef RMAT_GENERATOR_H
+#define RMAT_GENERATOR_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "csr_graph.h"
+
+// Graph500 Kronecker/RMAT initiator probabilities; d = 1 - a - b - c
+#define RMAT_A 0.57
+#define RMAT_B 0.19
+#define RMAT_C 0.19
+#define RMAT_EDGE_FACTOR 16 // Edges per vertex when none is given
+
+inline std::uint64_t splitMix64(std::uint64_t &state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Function to relabel a vertex with a bijection on [0, 2^scale), so the
+// high-degree vertices RMAT puts at low ids are spread over the id space
+inline vertex_t scrambleVertex(std::uint64_t v, int scale, std::uint64_t seed) {
+    const std::uint64_t mask = (std::uint64_t(1) << scale) - 1;
+    const int shift = scale / 2 + 1;
+    v = (v * (0x9E3779B97F4A7C15ull | 1) + seed) & mask;
+    v ^= v >> shift;
+    v = (v * (0xD6E8FEB86659FD93ull | 1)) & mask;
+    v ^= v >> shift;
+    return static_cast<vertex_t>(v);
+}
+
+// Function to generate edges [firstEdge, firstEdge + count) of an RMAT graph
+// with 2^scale vertices. Each edge draws from its own counter-based stream
+// seeded by (seed, edge index), so any split of the edge range, over threads
+// or ranks, produces exactly the same graph.
+inline std::vector<Edge> generateRMAT(int scale, std::uint64_t firstEdge, std::uint64_t count, std::uint64_t seed = 1) {
+    std::vector<Edge> edges(count);
+    const double ab = RMAT_A + RMAT_B;
+    const double aNorm = RMAT_A / ab;
+    const double cNorm = RMAT_C / (1.0 - ab);
+
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < static_cast<long long>(count); i++) {
+        std::uint64_t state = seed * 0x2545F4914F6CDD1Dull + firstEdge + static_cast<std::uint64_t>(i);
+        std::uint64_t u = 0, v = 0;
+        for (int level = 0; level < scale; level++) {
+            const double first = static_cast<double>(splitMix64(state) >> 11) * 0x1.0p-53;
+            const double second = static_cast<double>(splitMix64(state) >> 11) * 0x1.0p-53;
+            const std::uint64_t down = first > ab;                        // Lower half of the matrix
+            const std::uint64_t right = second > (down ? cNorm : aNorm);  // Right half
+            u = (u << 1) | down;
+            v = (v << 1) | right;
+        }
+        edges[i] = Edge{scrambleVertex(u, scale, seed), scrambleVertex(v, scale, seed)};
+    }
+    return edges;
+}
+
+// Function to recognise a "rmat:SCALE[:EDGE_FACTOR]" graph spec
+inline bool parseRMATSpec(const std::string &spec, int &scale, int &edgeFactor) {
+    if (spec.compare(0, 5, "rmat:") != 0) return false;
+    char *rest = nullptr;
+    scale = static_cast<int>(std::strtol(spec.c_str() + 5, &rest, 10));
+    edgeFactor = *rest == ':' ? static_cast<int>(std::strtol(rest + 1, nullptr, 10)) : RMAT_EDGE_FACTOR;
+    return scale > 0 && scale < 32 && edgeFactor > 0;
+}
+
+#endif // RMAT_GENERATOR_H
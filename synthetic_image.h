@@ -0,0 +1,58 @@
+#ifndef SYNTHETIC_IMAGE_H
+#define SYNTHETIC_IMAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#define SYNTHETIC_MEAN 128.0    // Centre of the Gaussian distribution
+#define SYNTHETIC_STDDEV 30.0
+#define SYNTHETIC_CONSTANT 7    // Value of every pixel in a constant image / flat stripe
+#define SYNTHETIC_STRIPES 8     // Noise/flat bands in a striped image
+
+// Uniform: every value equally likely. Gaussian: a realistic bell-shaped
+// histogram. Constant: one value everywhere, the worst case for shared
+// counters. Striped: alternating bands of noisy and flat rows, so contiguous
+// static partitions get very different amounts of work.
+enum class PixelDistribution { Uniform, Gaussian, Constant, Striped };
+
+inline const char *distributionName(PixelDistribution distribution) {
+    switch (distribution) {
+        case PixelDistribution::Uniform: return "uniform";
+        case PixelDistribution::Gaussian: return "gaussian";
+        case PixelDistribution::Constant: return "constant";
+        case PixelDistribution::Striped: return "striped";
+    }
+    return "unknown";
+}
+
+// Function to generate a width x height image in memory. Each row has its own
+// generator seeded from (seed, row), so the output is identical for any thread count.
+inline std::vector<unsigned char> generateImage(int width, int height, PixelDistribution distribution, unsigned int seed = 1) {
+    std::vector<unsigned char> image(static_cast<std::size_t>(width) * height);
+    const int stripeRows = std::max(1, height / SYNTHETIC_STRIPES);
+
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        unsigned char *row = image.data() + static_cast<std::size_t>(y) * width;
+        std::mt19937 engine(seed * 2654435761u + static_cast<unsigned int>(y));
+        bool noisy = distribution == PixelDistribution::Uniform ||
+                     (distribution == PixelDistribution::Striped && (y / stripeRows) % 2 == 0);
+
+        if (distribution == PixelDistribution::Gaussian) {
+            std::normal_distribution<double> normal(SYNTHETIC_MEAN, SYNTHETIC_STDDEV);
+            for (int x = 0; x < width; x++) {
+                row[x] = static_cast<unsigned char>(std::min(255.0, std::max(0.0, normal(engine) + 0.5)));
+            }
+        } else if (noisy) {
+            for (int x = 0; x < width; x++) row[x] = static_cast<unsigned char>(engine());
+        } else {
+            std::fill(row, row + width, static_cast<unsigned char>(SYNTHETIC_CONSTANT));
+        }
+    }
+    return image;
+}
+
+#endif // SYNTHETIC_IMAGE_H
@@ -0,0 +1,127 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+#define TRACE_CAPACITY 4096 // Events kept per thread (power of two); older events are overwritten
+
+// Function to read a cheap monotonic timestamp: the TSC on x86, nanoseconds elsewhere
+inline std::uint64_t traceClock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// One fixed-size record: which thread ran which chunk, and when
+struct TraceEvent {
+    std::uint32_t threadId;
+    std::int32_t chunkStart;
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+// Ring of events written by exactly one thread. Nothing is shared with the
+// other threads' rings, so recording is a plain store plus an index bump.
+struct alignas(CACHE_LINE_SIZE) TraceRing {
+    std::vector<TraceEvent> events = std::vector<TraceEvent>(TRACE_CAPACITY);
+    std::uint64_t written = 0;
+
+    void record(std::uint32_t threadId, std::int32_t chunkStart, std::uint64_t begin, std::uint64_t end) {
+        events[written & (TRACE_CAPACITY - 1)] = TraceEvent{threadId, chunkStart, begin, end};
+        written++;
+    }
+};
+
+// Per-thread tracing for a parallel region. Rings are allocated up front; the
+// recorded events are only read after the region has finished.
+class Tracer {
+public:
+    explicit Tracer(int numThreads)
+        : rings(numThreads), startTicks(traceClock()), startTime(std::chrono::steady_clock::now()) {}
+
+    void record(int threadId, int chunkStart, std::uint64_t begin, std::uint64_t end) {
+        rings[threadId].record(static_cast<std::uint32_t>(threadId), chunkStart, begin, end);
+    }
+
+    // Function to write the events as Chrome trace / Perfetto JSON
+    bool writeChromeTrace(const std::string &filename) const {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "ERROR: Could not open trace file " << filename << std::endl;
+            return false;
+        }
+        const double usPerTick = microsecondsPerTick();
+        bool first = true;
+        file << "{\"traceEvents\":[\n";
+        for (const TraceRing &ring : rings) {
+            forEachEvent(ring, [&](const TraceEvent &event) {
+                file << (first ? "" : ",\n")
+                     << "{\"name\":\"chunk\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.threadId
+                     << ",\"ts\":" << (event.begin - startTicks) * usPerTick
+                     << ",\"dur\":" << (event.end - event.begin) * usPerTick
+                     << ",\"args\":{\"row\":" << event.chunkStart << "}}";
+                first = false;
+            });
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return true;
+    }
+
+    // Function to print per-thread chunk counts, busy time and the max/mean imbalance
+    void printImbalanceSummary(std::ostream &out) const {
+        const double msPerTick = microsecondsPerTick() / 1000.0;
+        double maxBusy = 0.0, totalBusy = 0.0;
+        int activeThreads = 0;
+        for (std::size_t t = 0; t < rings.size(); t++) {
+            double busy = 0.0;
+            forEachEvent(rings[t], [&](const TraceEvent &event) { busy += (event.end - event.begin) * msPerTick; });
+            out << "Thread " << t << " -> Chunks: " << rings[t].written << ", busy time: " << busy << " ms.\n";
+            if (rings[t].written > TRACE_CAPACITY) {
+                out << "  (only the last " << TRACE_CAPACITY << " chunks were kept)\n";
+            }
+            maxBusy = std::max(maxBusy, busy);
+            totalBusy += busy;
+            activeThreads++;
+        }
+        if (activeThreads > 0 && totalBusy > 0.0) {
+            out << "Load imbalance (max / mean busy time): " << maxBusy / (totalBusy / activeThreads) << "\n";
+        }
+    }
+
+private:
+    template <typename Visit>
+    static void forEachEvent(const TraceRing &ring, Visit visit) {
+        std::uint64_t first = ring.written > TRACE_CAPACITY ? ring.written - TRACE_CAPACITY : 0;
+        for (std::uint64_t i = first; i < ring.written; i++) {
+            visit(ring.events[i & (TRACE_CAPACITY - 1)]);
+        }
+    }
+
+    // Ticks are converted lazily against the wall clock elapsed since construction
+    double microsecondsPerTick() const {
+        std::uint64_t ticks = traceClock() - startTicks;
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+        return ticks > 0 ? elapsed.count() / static_cast<double>(ticks) : 0.0;
+    }
+
+    std::vector<TraceRing> rings;
+    std::uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+#endif // TRACE_H
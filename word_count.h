@@ -0,0 +1,221 @@
+#ifndef WORD_COUNT_H
+#define WORD_COUNT_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "corpus_reader.h"
+
+#define WORDCOUNT_FLUSH_BYTES (64 << 20) // Local table size that triggers a shuffle
+#define WORDCOUNT_CHUNK (16 << 20)       // Bytes of a mapped slice tokenized between shuffle checks
+#define WORDCOUNT_MIN_SLOTS 1024         // Power of two
+
+// FNV-1a, finished with a splitmix step so the high bits (which pick the
+// owner rank) are as well mixed as the low bits (which pick the slot)
+inline std::uint64_t hashWord(const char *word, std::size_t length) {
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for (std::size_t i = 0; i < length; i++) h = (h ^ static_cast<unsigned char>(word[i])) * 0x100000001B3ull;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+inline int wordOwner(std::uint64_t hash, int size) {
+    return static_cast<int>(((hash >> 32) * static_cast<std::uint64_t>(size)) >> 32);
+}
+
+// Open-addressing word -> count table with linear probing. Word bytes live
+// in one arena, so inserting a new word costs no allocation of its own.
+class WordCountTable {
+public:
+    struct Slot {
+        std::uint64_t hash = 0;
+        std::uint64_t count = 0; // 0 marks an empty slot
+        std::uint64_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    WordCountTable() { clear(); }
+
+    void add(const char *word, std::size_t length, std::uint64_t count = 1) {
+        add(word, length, hashWord(word, length), count);
+    }
+
+    void add(const char *word, std::size_t length, std::uint64_t hash, std::uint64_t count) {
+        if ((used + 1) * 10 > slots.size() * 7) grow();
+        const std::size_t mask = slots.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot &slot = slots[i];
+            if (slot.count == 0) {
+                slot.hash = hash;
+                slot.count = count;
+                slot.offset = arena.size();
+                slot.length = static_cast<std::uint32_t>(length);
+                arena.insert(arena.end(), word, word + length);
+                used++;
+                return;
+            }
+            if (slot.hash == hash && slot.length == length && std::memcmp(arena.data() + slot.offset, word, length) == 0) {
+                slot.count += count;
+                return;
+            }
+        }
+    }
+
+    // Function to look up a word's count; 0 when absent
+    std::uint64_t find(const char *word, std::size_t length) const {
+        const std::uint64_t hash = hashWord(word, length);
+        const std::size_t mask = slots.size() - 1;
+        for (std::size_t i = hash & mask; slots[i].count != 0; i = (i + 1) & mask) {
+            const Slot &slot = slots[i];
+            if (slot.hash == hash && slot.length == length && std::memcmp(arena.data() + slot.offset, word, length) == 0) return slot.count;
+        }
+        return 0;
+    }
+
+    // Function to call visit(word, length, hash, count) for every entry
+    template <typename Visitor>
+    void forEach(Visitor &&visit) const {
+        for (const Slot &slot : slots) {
+            if (slot.count != 0) visit(arena.data() + slot.offset, static_cast<std::size_t>(slot.length), slot.hash, slot.count);
+        }
+    }
+
+    void clear() {
+        slots.assign(WORDCOUNT_MIN_SLOTS, Slot());
+        arena.clear();
+        used = 0;
+    }
+
+    std::size_t size() const { return used; }
+    std::size_t memoryBytes() const { return slots.size() * sizeof(Slot) + arena.size(); }
+
+private:
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        const std::size_t mask = slots.size() - 1;
+        for (const Slot &slot : old) {
+            if (slot.count == 0) continue;
+            std::size_t i = slot.hash & mask;
+            while (slots[i].count != 0) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+
+    std::vector<Slot> slots;
+    std::vector<char> arena;
+    std::size_t used = 0;
+};
+
+// Function to send every entry of `local` to the rank owning its hash with
+// one MPI_Alltoallv and merge what arrives into `owned`. Entries travel as
+// a uint64 count, a uint32 length and the word bytes. `local` is emptied.
+inline void shuffleWordCounts(WordCountTable &local, WordCountTable &owned, MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    const std::size_t fixed = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+    std::vector<int> sendCounts(size, 0), recvCounts(size), sendDispls(size + 1, 0), recvDispls(size + 1, 0);
+    local.forEach([&](const char *, std::size_t length, std::uint64_t hash, std::uint64_t) {
+        sendCounts[wordOwner(hash, size)] += static_cast<int>(fixed + length);
+    });
+    for (int r = 0; r < size; r++) sendDispls[r + 1] = sendDispls[r] + sendCounts[r];
+    std::vector<char> sendBuffer(sendDispls[size]);
+    std::vector<int> cursor(sendDispls.begin(), sendDispls.end() - 1);
+    local.forEach([&](const char *word, std::size_t length, std::uint64_t hash, std::uint64_t count) {
+        char *out = sendBuffer.data() + cursor[wordOwner(hash, size)];
+        const std::uint32_t length32 = static_cast<std::uint32_t>(length);
+        std::memcpy(out, &count, sizeof(count));
+        std::memcpy(out + sizeof(count), &length32, sizeof(length32));
+        std::memcpy(out + fixed, word, length);
+        cursor[wordOwner(hash, size)] += static_cast<int>(fixed + length);
+    });
+    local.clear();
+
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+    for (int r = 0; r < size; r++) recvDispls[r + 1] = recvDispls[r] + recvCounts[r];
+    std::vector<char> recvBuffer(recvDispls[size]);
+    MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_CHAR,
+                  recvBuffer.data(), recvCounts.data(), recvDispls.data(), MPI_CHAR, comm);
+
+    for (const char *in = recvBuffer.data(), *end = in + recvBuffer.size(); in < end;) {
+        std::uint64_t count;
+        std::uint32_t length;
+        std::memcpy(&count, in, sizeof(count));
+        std::memcpy(&length, in + sizeof(count), sizeof(length));
+        owned.add(in + fixed, length, count);
+        in += fixed + length;
+    }
+}
+
+// Function for all ranks to agree on whether to shuffle now: when any local
+// table has outgrown WORDCOUNT_FLUSH_BYTES, or once every rank is out of
+// input. Returns true while some rank still has input to map.
+inline bool shuffleIfFull(WordCountTable &local, WordCountTable &owned, bool finished, MPI_Comm comm) {
+    int state[2] = {local.memoryBytes() > WORDCOUNT_FLUSH_BYTES, !finished}, global[2];
+    MPI_Allreduce(state, global, 2, MPI_INT, MPI_MAX, comm);
+    if (global[0] || !global[1]) shuffleWordCounts(local, owned, comm);
+    return global[1] != 0;
+}
+
+// Function to map a word-aligned slice of a mapped corpus in
+// WORDCOUNT_CHUNK pieces, shuffling whenever a local table fills up, so
+// memory stays bounded however large the slice. Collective over `comm`.
+inline void countSliceWords(const CorpusSlice &slice, WordCountTable &local, WordCountTable &owned, MPI_Comm comm) {
+    const char *data = slice.file.data();
+    const std::size_t size = slice.file.size();
+    std::size_t pos = static_cast<std::size_t>(slice.begin - data);
+    const std::size_t end = static_cast<std::size_t>(slice.end - data);
+    do {
+        const std::size_t stop = std::min(end, alignToWord(data, size, std::min(end, pos + WORDCOUNT_CHUNK)));
+        forEachWord(data + pos, data + stop, [&](const char *word, std::size_t length) { local.add(word, length); });
+        pos = stop;
+    } while (shuffleIfFull(local, owned, pos >= end, comm));
+}
+
+struct WordEntry {
+    const char *word;
+    std::size_t length;
+    std::uint64_t count;
+};
+
+// Byte order, shorter first on a shared prefix
+inline int compareWords(const char *a, std::size_t aLength, const char *b, std::size_t bLength) {
+    int order = std::memcmp(a, b, std::min(aLength, bLength));
+    return order != 0 ? order : (aLength < bLength ? -1 : aLength > bLength ? 1 : 0);
+}
+
+// Function to list a table's entries in word order; they point into the table
+inline std::vector<WordEntry> sortedWordEntries(const WordCountTable &table) {
+    std::vector<WordEntry> entries;
+    entries.reserve(table.size());
+    table.forEach([&](const char *word, std::size_t length, std::uint64_t, std::uint64_t count) {
+        entries.push_back(WordEntry{word, length, count});
+    });
+    std::sort(entries.begin(), entries.end(), [](const WordEntry &a, const WordEntry &b) {
+        return compareWords(a.word, a.length, b.word, b.length) < 0;
+    });
+    return entries;
+}
+
+// Function to write a rank's owned words, sorted, one "word count" per line
+inline bool writeWordCounts(const WordCountTable &owned, const std::string &filename) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not create " << filename << std::endl;
+        return false;
+    }
+    for (const WordEntry &entry : sortedWordEntries(owned)) {
+        file.write(entry.word, static_cast<std::streamsize>(entry.length));
+        file << ' ' << entry.count << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+#endif // WORD_COUNT_H
@@ -0,0 +1,199 @@
+#ifndef WORD_INDEX_H
+#define WORD_INDEX_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "word_count.h"
+
+#define INDEX_MAGIC "WORDIDX1"
+
+// On-disk word index. Every build appends one segment covering one
+// document (a corpus file) and writes one shard per rank; a word lives in
+// shard wordOwner(hash, shards), the rank that owned it during the
+// shuffle. <prefix>.manifest lists the segments, one
+// "<shards> <document>" line each, and a segment only becomes visible once
+// its line is written, after all of its shards.
+//
+// Shard file: IndexShardHeader, then numTerms IndexEntry records sorted by
+// word, then the word bytes the entries point into.
+struct IndexShardHeader {
+    char magic[8];
+    std::uint64_t numTerms;
+    std::uint64_t totalWords;
+};
+
+struct IndexEntry {
+    std::uint64_t offset; // Into the word bytes
+    std::uint64_t count;
+    std::uint32_t length;
+    std::uint32_t reserved;
+};
+
+struct IndexSegment {
+    int shards;
+    std::string document;
+};
+
+inline std::string manifestPath(const std::string &prefix) {
+    return prefix + ".manifest";
+}
+
+inline std::string shardPath(const std::string &prefix, std::size_t segment, int shard) {
+    return prefix + "." + std::to_string(segment) + "." + std::to_string(shard);
+}
+
+// Function to read the segment list; a missing manifest is an empty index
+inline bool readManifest(const std::string &prefix, std::vector<IndexSegment> &segments) {
+    segments.clear();
+    std::ifstream file(manifestPath(prefix));
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        IndexSegment segment;
+        if (!(fields >> segment.shards) || segment.shards <= 0) {
+            std::cerr << "ERROR: Malformed manifest line in " << manifestPath(prefix) << std::endl;
+            return false;
+        }
+        std::getline(fields >> std::ws, segment.document);
+        segments.push_back(segment);
+    }
+    return true;
+}
+
+inline bool appendManifest(const std::string &prefix, const IndexSegment &segment) {
+    std::ofstream file(manifestPath(prefix), std::ios::app);
+    file << segment.shards << ' ' << segment.document << '\n';
+    if (!file) std::cerr << "ERROR: Could not update " << manifestPath(prefix) << std::endl;
+    return static_cast<bool>(file);
+}
+
+// Function to write one rank's owned words as an index shard
+inline bool writeIndexShard(const WordCountTable &owned, const std::string &filename) {
+    std::vector<WordEntry> words = sortedWordEntries(owned);
+    IndexShardHeader header;
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.numTerms = words.size();
+    header.totalWords = 0;
+    std::vector<IndexEntry> entries(words.size());
+    std::uint64_t offset = 0;
+    for (std::size_t i = 0; i < words.size(); i++) {
+        entries[i] = IndexEntry{offset, words[i].count, static_cast<std::uint32_t>(words[i].length), 0};
+        offset += words[i].length;
+        header.totalWords += words[i].count;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not create " << filename << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(IndexEntry)));
+    for (const WordEntry &word : words) file.write(word.word, static_cast<std::streamsize>(word.length));
+    return static_cast<bool>(file);
+}
+
+// A mapped shard answering lookups by binary search over its entries
+class IndexShard {
+public:
+    bool open(const std::string &filename) {
+        if (!file.open(filename, MADV_RANDOM)) return false;
+        if (file.size() < sizeof(IndexShardHeader)) return invalid(filename);
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+            header.numTerms > (file.size() - sizeof(header)) / sizeof(IndexEntry)) return invalid(filename);
+        const std::uint64_t entryBytes = header.numTerms * sizeof(IndexEntry);
+        const std::uint64_t wordBytes = file.size() - sizeof(header) - entryBytes;
+        entries = reinterpret_cast<const IndexEntry *>(file.data() + sizeof(header));
+        words = file.data() + sizeof(header) + entryBytes;
+        // Every entry's word must lie inside the file before find() trusts it
+        for (std::uint64_t i = 0; i < header.numTerms; i++) {
+            if (entries[i].offset > wordBytes || entries[i].length > wordBytes - entries[i].offset) return invalid(filename);
+        }
+        return true;
+    }
+
+    // Function to look up a word's count; 0 when absent
+    std::uint64_t find(const char *word, std::size_t length) const {
+        std::uint64_t low = 0, high = header.numTerms;
+        while (low < high) {
+            const std::uint64_t mid = low + (high - low) / 2;
+            const IndexEntry &entry = entries[mid];
+            int order = compareWords(words + entry.offset, entry.length, word, length);
+            if (order == 0) return entry.count;
+            if (order < 0) low = mid + 1;
+            else high = mid;
+        }
+        return 0;
+    }
+
+    std::uint64_t totalWords() const { return header.totalWords; }
+
+private:
+    bool invalid(const std::string &filename) {
+        std::cerr << "ERROR: " << filename << " is not a word index shard" << std::endl;
+        file.close();
+        return false;
+    }
+
+    MappedFile file;
+    IndexShardHeader header = {};
+    const IndexEntry *entries = nullptr;
+    const char *words = nullptr;
+};
+
+// All segments of an index. Shards are mapped and checked on first use, so a
+// lookup opens at most one new shard per segment.
+class WordIndex {
+public:
+    bool open(const std::string &indexPrefix) {
+        prefix = indexPrefix;
+        if (!readManifest(prefix, segments)) return false;
+        if (segments.empty()) {
+            std::cerr << "ERROR: No index segments in " << manifestPath(prefix) << std::endl;
+            return false;
+        }
+        shards.clear();
+        shards.resize(segments.size());
+        for (std::size_t s = 0; s < segments.size(); s++) shards[s].resize(segments[s].shards);
+        return true;
+    }
+
+    // Function to count a word in every segment; counts[s] is segment s's.
+    // Fails, rather than undercounting, if a shard it needs is missing or corrupt.
+    bool lookup(const std::string &word, std::vector<std::uint64_t> &counts, std::uint64_t &total) {
+        counts.assign(segments.size(), 0);
+        total = 0;
+        const std::uint64_t hash = hashWord(word.data(), word.size());
+        for (std::size_t s = 0; s < segments.size(); s++) {
+            const int shard = wordOwner(hash, segments[s].shards);
+            std::unique_ptr<IndexShard> &mapped = shards[s][shard];
+            if (!mapped) {
+                mapped.reset(new IndexShard());
+                if (!mapped->open(shardPath(prefix, s, shard))) {
+                    mapped.reset();
+                    return false;
+                }
+            }
+            counts[s] = mapped->find(word.data(), word.size());
+            total += counts[s];
+        }
+        return true;
+    }
+
+    const std::vector<IndexSegment> &segmentList() const { return segments; }
+
+private:
+    std::string prefix;
+    std::vector<IndexSegment> segments;
+    std::vector<std::vector<std::unique_ptr<IndexShard> > > shards;
+};
+
+#endif // WORD_INDEX_H
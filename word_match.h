@@ -0,0 +1,124 @@
+#ifndef WORD_MATCH_H
+#define WORD_MATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "corpus_reader.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WORD_MATCH_X86 1
+#endif
+
+// Whole-word search straight over corpus text, without tokenizing it. A
+// candidate is any position whose first and last bytes equal the query's
+// (compared a register of positions at a time). It counts when the bytes
+// between also match and separators or the range ends sit on both sides.
+// Because corpus slices are word-aligned, `begin` is always a boundary.
+
+inline bool matchAt(const char *begin, const char *end, const char *pos, const char *word, std::size_t length) {
+    return std::memcmp(pos + 1, word + 1, length - 1) == 0
+        && (pos == begin || !isWordByte(pos[-1]))
+        && (pos + length == end || !isWordByte(pos[length]));
+}
+
+// Scalar fallback, also used for the tail the vector kernels leave
+inline long long countMatchesScalar(const char *begin, const char *end, const char *from, const char *word, std::size_t length) {
+    long long count = 0;
+    for (const char *pos = from; pos <= end - length; pos++) {
+        if (pos[0] == word[0] && pos[length - 1] == word[length - 1]) count += matchAt(begin, end, pos, word, length);
+    }
+    return count;
+}
+
+inline long long confirmCandidates(std::uint64_t mask, const char *block, const char *begin, const char *end, const char *word, std::size_t length) {
+    long long count = 0;
+    for (; mask != 0; mask &= mask - 1) count += matchAt(begin, end, block + __builtin_ctzll(mask), word, length);
+    return count;
+}
+
+inline long long countMatchesPlain(const char *begin, const char *end, const char *word, std::size_t length) {
+    return countMatchesScalar(begin, end, begin, word, length);
+}
+
+#ifdef WORD_MATCH_X86
+// SSE2: 16 candidate positions per pair of compares
+inline long long countMatchesSSE2(const char *begin, const char *end, const char *word, std::size_t length) {
+    const __m128i first = _mm_set1_epi8(word[0]);
+    const __m128i last = _mm_set1_epi8(word[length - 1]);
+    const std::size_t n = static_cast<std::size_t>(end - begin);
+    long long count = 0;
+    std::size_t i = 0;
+    for (; i + length - 1 + 16 <= n; i += 16) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin + i));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin + i + length - 1));
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last)));
+        if (mask != 0) count += confirmCandidates(mask, begin + i, begin, end, word, length);
+    }
+    return count + countMatchesScalar(begin, end, begin + i, word, length);
+}
+
+// AVX2: 32 candidate positions per pair of compares
+__attribute__((target("avx2")))
+inline long long countMatchesAVX2(const char *begin, const char *end, const char *word, std::size_t length) {
+    const __m256i first = _mm256_set1_epi8(word[0]);
+    const __m256i last = _mm256_set1_epi8(word[length - 1]);
+    const std::size_t n = static_cast<std::size_t>(end - begin);
+    long long count = 0;
+    std::size_t i = 0;
+    for (; i + length - 1 + 32 <= n; i += 32) {
+        __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin + i));
+        __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin + i + length - 1));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last))));
+        if (mask != 0) count += confirmCandidates(mask, begin + i, begin, end, word, length);
+    }
+    return count + countMatchesScalar(begin, end, begin + i, word, length);
+}
+
+// AVX-512BW: 64 candidate positions per pair of mask compares
+__attribute__((target("avx512f,avx512bw")))
+inline long long countMatchesAVX512(const char *begin, const char *end, const char *word, std::size_t length) {
+    const __m512i first = _mm512_set1_epi8(word[0]);
+    const __m512i last = _mm512_set1_epi8(word[length - 1]);
+    const std::size_t n = static_cast<std::size_t>(end - begin);
+    long long count = 0;
+    std::size_t i = 0;
+    for (; i + length - 1 + 64 <= n; i += 64) {
+        __m512i head = _mm512_loadu_si512(reinterpret_cast<const void *>(begin + i));
+        __m512i tail = _mm512_loadu_si512(reinterpret_cast<const void *>(begin + i + length - 1));
+        std::uint64_t mask = _mm512_cmpeq_epi8_mask(head, first) & _mm512_cmpeq_epi8_mask(tail, last);
+        if (mask != 0) count += confirmCandidates(mask, begin + i, begin, end, word, length);
+    }
+    return count + countMatchesScalar(begin, end, begin + i, word, length);
+}
+#endif
+
+using WordMatchKernel = long long (*)(const char *, const char *, const char *, std::size_t);
+
+// Function to pick the widest kernel the running CPU supports
+inline WordMatchKernel selectWordMatchKernel() {
+#ifdef WORD_MATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) return countMatchesAVX512;
+    if (__builtin_cpu_supports("avx2")) return countMatchesAVX2;
+    return countMatchesSSE2;
+#else
+    return countMatchesPlain;
+#endif
+}
+
+// Function to count whole-word occurrences of `word` in [begin, end), where
+// `begin` is a word boundary. Gives the same count as tokenizing the range
+// and comparing every token, so a query holding a separator never matches.
+inline long long countWordMatches(const char *begin, const char *end, const std::string &word) {
+    static const WordMatchKernel kernel = selectWordMatchKernel();
+    if (word.empty() || static_cast<std::size_t>(end - begin) < word.size()) return 0;
+    for (char c : word) {
+        if (!isWordByte(c)) return 0;
+    }
+    return kernel(begin, end, word.data(), word.size());
+}
+
+#endif // WORD_MATCH_H
@@ -0,0 +1,255 @@
+#ifndef WORD_SKETCH_H
+#define WORD_SKETCH_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "word_count.h"
+
+#define SKETCH_DEPTH 4          // Count-Min rows: estimates hold with probability 1 - e^-depth
+#define SKETCH_WIDTH (1 << 16)  // Count-Min columns, power of two: overestimate at most e / width of the total
+#define SKETCH_CAPACITY 4096    // Space-Saving counters: every word above total / capacity is kept
+#define SKETCH_WORD_BYTES 32    // Word bytes kept per counter for the report
+
+// Space-Saving counter. The word's true frequency lies in
+// [count - error, count]. Words are identified by their 64-bit hash; only
+// the first SKETCH_WORD_BYTES bytes are kept for printing.
+struct SketchCounter {
+    std::uint64_t hash;
+    std::uint64_t count;
+    std::uint64_t error;
+    std::uint32_t length;
+    char word[SKETCH_WORD_BYTES];
+};
+
+// A Count-Min sketch plus a Space-Saving summary, in one flat block of
+// fixed size, so it can travel as a single MPI element and be merged by a
+// reduction operator. Memory and message size do not depend on the
+// vocabulary.
+struct WordSketch {
+    std::uint64_t total;
+    std::uint64_t used;
+    std::uint64_t rows[SKETCH_DEPTH][SKETCH_WIDTH];
+    SketchCounter counters[SKETCH_CAPACITY];
+};
+
+// Row r uses h1 + r * h2 (Kirsch-Mitzenmacher), both halves of the word hash
+inline std::size_t sketchColumn(std::uint64_t hash, int row) {
+    const std::uint64_t h1 = hash & 0xFFFFFFFFull, h2 = (hash >> 32) | 1;
+    return static_cast<std::size_t>((h1 + static_cast<std::uint64_t>(row) * h2) & (SKETCH_WIDTH - 1));
+}
+
+inline std::uint64_t sketchEstimate(const WordSketch &sketch, std::uint64_t hash) {
+    std::uint64_t estimate = UINT64_MAX;
+    for (int r = 0; r < SKETCH_DEPTH; r++) estimate = std::min(estimate, sketch.rows[r][sketchColumn(hash, r)]);
+    return estimate;
+}
+
+inline std::uint64_t smallestCount(const WordSketch &sketch) {
+    if (sketch.used < SKETCH_CAPACITY) return 0; // A word that is absent was never seen
+    std::uint64_t smallest = UINT64_MAX;
+    for (std::uint64_t i = 0; i < sketch.used; i++) smallest = std::min(smallest, sketch.counters[i].count);
+    return smallest;
+}
+
+// Fills one rank's sketch from its word stream. A min-heap over the
+// counters finds the one to replace, and a linear-probing index maps word
+// hashes to counters; both are fixed in size, so nothing is allocated per word.
+class SketchBuilder {
+public:
+    explicit SketchBuilder(WordSketch &target)
+        : sketch(target), heap(SKETCH_CAPACITY), where(SKETCH_CAPACITY), slots(2 * SKETCH_CAPACITY, -1) {
+        std::memset(&sketch, 0, sizeof(sketch));
+    }
+
+    void add(const char *word, std::size_t length) {
+        const std::uint64_t hash = hashWord(word, length);
+        sketch.total++;
+        for (int r = 0; r < SKETCH_DEPTH; r++) sketch.rows[r][sketchColumn(hash, r)]++;
+
+        std::int32_t c = find(hash);
+        if (c >= 0) {
+            sketch.counters[c].count++;
+            siftDown(where[c]);
+            return;
+        }
+        std::uint64_t floor = 0;
+        if (sketch.used < SKETCH_CAPACITY) {
+            c = static_cast<std::int32_t>(sketch.used++);
+            heap[c] = c;
+            where[c] = c;
+        } else {
+            // Replace the smallest counter; the newcomer inherits its count as error
+            c = heap[0];
+            floor = sketch.counters[c].count;
+            erase(sketch.counters[c].hash);
+        }
+        SketchCounter &counter = sketch.counters[c];
+        counter.hash = hash;
+        counter.count = floor + 1;
+        counter.error = floor;
+        counter.length = static_cast<std::uint32_t>(length);
+        std::memcpy(counter.word, word, std::min<std::size_t>(length, SKETCH_WORD_BYTES));
+        insert(hash, c);
+        siftUp(where[c]);
+        siftDown(where[c]);
+    }
+
+private:
+    std::size_t slotOf(std::uint64_t hash) const { return hash & (slots.size() - 1); }
+
+    std::int32_t find(std::uint64_t hash) const {
+        for (std::size_t i = slotOf(hash); slots[i] >= 0; i = (i + 1) & (slots.size() - 1)) {
+            if (sketch.counters[slots[i]].hash == hash) return slots[i];
+        }
+        return -1;
+    }
+
+    void insert(std::uint64_t hash, std::int32_t counter) {
+        std::size_t i = slotOf(hash);
+        while (slots[i] >= 0) i = (i + 1) & (slots.size() - 1);
+        slots[i] = counter;
+    }
+
+    // Backward-shift deletion keeps every probe chain unbroken without tombstones
+    void erase(std::uint64_t hash) {
+        const std::size_t mask = slots.size() - 1;
+        std::size_t i = slotOf(hash);
+        while (sketch.counters[slots[i]].hash != hash) i = (i + 1) & mask;
+        for (std::size_t j = (i + 1) & mask; slots[j] >= 0; j = (j + 1) & mask) {
+            const std::size_t home = slotOf(sketch.counters[slots[j]].hash);
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = -1;
+    }
+
+    std::uint64_t countAt(std::int32_t position) const { return sketch.counters[heap[position]].count; }
+
+    void swapAt(std::int32_t a, std::int32_t b) {
+        std::swap(heap[a], heap[b]);
+        where[heap[a]] = a;
+        where[heap[b]] = b;
+    }
+
+    void siftUp(std::int32_t position) {
+        while (position > 0 && countAt((position - 1) / 2) > countAt(position)) {
+            swapAt(position, (position - 1) / 2);
+            position = (position - 1) / 2;
+        }
+    }
+
+    void siftDown(std::int32_t position) {
+        const std::int32_t size = static_cast<std::int32_t>(sketch.used);
+        while (true) {
+            std::int32_t smallest = position, left = 2 * position + 1, right = left + 1;
+            if (left < size && countAt(left) < countAt(smallest)) smallest = left;
+            if (right < size && countAt(right) < countAt(smallest)) smallest = right;
+            if (smallest == position) return;
+            swapAt(position, smallest);
+            position = smallest;
+        }
+    }
+
+    WordSketch &sketch;
+    std::vector<std::int32_t> heap;  // Counter indices, smallest count on top
+    std::vector<std::int32_t> where; // Heap position of each counter
+    std::vector<std::int32_t> slots; // Word hash -> counter, -1 when empty
+};
+
+// Function to merge sketch `in` into `inout`. Count-Min rows add up. For
+// Space-Saving, a word missing from a full summary may still have occurred
+// up to that summary's smallest count, so that much is added to both its
+// count and its error; then the largest SKETCH_CAPACITY counters are kept.
+// The result keeps both summaries' guarantees (Agarwal et al., "Mergeable
+// Summaries").
+inline void mergeSketches(const WordSketch &in, WordSketch &inout) {
+    inout.total += in.total;
+    for (int r = 0; r < SKETCH_DEPTH; r++) {
+        for (std::size_t c = 0; c < SKETCH_WIDTH; c++) inout.rows[r][c] += in.rows[r][c];
+    }
+
+    const std::uint64_t inFloor = smallestCount(in), outFloor = smallestCount(inout);
+    auto byHash = [](const SketchCounter &a, const SketchCounter &b) { return a.hash < b.hash; };
+    std::vector<SketchCounter> a(in.counters, in.counters + in.used), b(inout.counters, inout.counters + inout.used), merged;
+    std::sort(a.begin(), a.end(), byHash);
+    std::sort(b.begin(), b.end(), byHash);
+    merged.reserve(a.size() + b.size());
+    std::size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (j == b.size() || (i < a.size() && a[i].hash < b[j].hash)) {
+            merged.push_back(a[i++]);
+            merged.back().count += outFloor;
+            merged.back().error += outFloor;
+        } else if (i == a.size() || b[j].hash < a[i].hash) {
+            merged.push_back(b[j++]);
+            merged.back().count += inFloor;
+            merged.back().error += inFloor;
+        } else {
+            merged.push_back(b[j]);
+            merged.back().count += a[i].count;
+            merged.back().error += a[i].error;
+            i++;
+            j++;
+        }
+    }
+    const std::size_t kept = std::min<std::size_t>(merged.size(), SKETCH_CAPACITY);
+    std::nth_element(merged.begin(), merged.begin() + (kept == 0 ? 0 : kept - 1), merged.end(),
+                     [](const SketchCounter &x, const SketchCounter &y) { return x.count > y.count; });
+    std::copy(merged.begin(), merged.begin() + kept, inout.counters);
+    inout.used = kept;
+}
+
+inline void mergeSketchOp(void *in, void *inout, int *len, MPI_Datatype *) {
+    const WordSketch *source = static_cast<const WordSketch *>(in);
+    WordSketch *target = static_cast<WordSketch *>(inout);
+    for (int i = 0; i < *len; i++) mergeSketches(source[i], target[i]);
+}
+
+// Function to merge every rank's sketch into `merged` on `root` with one
+// MPI_Reduce under a custom operator; the library's reduction tree moves
+// one sketch per edge. `merged` is only written on the root.
+inline void reduceSketch(const WordSketch &local, WordSketch &merged, int root, MPI_Comm comm) {
+    MPI_Datatype sketchType;
+    MPI_Type_contiguous(static_cast<int>(sizeof(WordSketch)), MPI_BYTE, &sketchType);
+    MPI_Type_commit(&sketchType);
+    MPI_Op mergeOp;
+    MPI_Op_create(mergeSketchOp, 1, &mergeOp);
+    MPI_Reduce(&local, &merged, 1, sketchType, mergeOp, root, comm);
+    MPI_Op_free(&mergeOp);
+    MPI_Type_free(&sketchType);
+}
+
+struct HeavyHitter {
+    std::string word;   // Cut to SKETCH_WORD_BYTES, with "..." when longer
+    std::uint64_t lower;
+    std::uint64_t upper;
+};
+
+// Function to list the k largest counters of a merged sketch with bounds on
+// each true count. The upper bound is the lesser of the Space-Saving count
+// and the Count-Min estimate (the latter holding with probability 1 - e^-depth).
+inline std::vector<HeavyHitter> topWords(const WordSketch &sketch, std::size_t k) {
+    std::vector<const SketchCounter *> order;
+    for (std::uint64_t i = 0; i < sketch.used; i++) order.push_back(&sketch.counters[i]);
+    std::sort(order.begin(), order.end(), [](const SketchCounter *a, const SketchCounter *b) { return a->count > b->count; });
+    std::vector<HeavyHitter> top;
+    for (std::size_t i = 0; i < std::min(k, order.size()); i++) {
+        const SketchCounter &counter = *order[i];
+        HeavyHitter hitter;
+        hitter.word.assign(counter.word, std::min<std::size_t>(counter.length, SKETCH_WORD_BYTES));
+        if (counter.length > SKETCH_WORD_BYTES) hitter.word += "...";
+        hitter.upper = std::min(counter.count, sketchEstimate(sketch, counter.hash));
+        hitter.lower = counter.count - counter.error;
+        top.push_back(hitter);
+    }
+    return top;
+}
+
+#endif // WORD_SKETCH_H
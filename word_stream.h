@@ -0,0 +1,133 @@
+#ifndef WORD_STREAM_H
+#define WORD_STREAM_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "corpus_reader.h"
+
+#define STREAM_BATCH_BYTES (1 << 20) // Largest word block sent to one rank per round
+#define STREAM_END (-1)              // Block size announcing that the stream is over
+
+// A block of variable-length words as it travels: a uint32 word count, then
+// count + 1 uint32 offsets into the packed bytes, then the bytes themselves.
+// Words keep their full length; nothing is padded or truncated.
+struct WordBatch {
+    std::uint32_t count = 0;
+    const std::uint32_t *offsets = nullptr;
+    const char *bytes = nullptr;
+
+    const char *word(std::uint32_t i) const { return bytes + offsets[i]; }
+    std::size_t length(std::uint32_t i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+inline WordBatch viewWordBatch(const std::vector<char> &block) {
+    WordBatch batch;
+    std::memcpy(&batch.count, block.data(), sizeof(batch.count));
+    batch.offsets = reinterpret_cast<const std::uint32_t *>(block.data() + sizeof(std::uint32_t));
+    batch.bytes = reinterpret_cast<const char *>(batch.offsets + batch.count + 1);
+    return batch;
+}
+
+// Function to take words from [pos, end) until the next one would push the
+// block past `capacity`, and append them to `out` in WordBatch layout. A
+// single word longer than the capacity still goes out, alone. `words` is
+// scratch space reused between calls. Returns the block size in bytes.
+inline int packWordBatch(const char *&pos, const char *end, std::size_t capacity,
+                         std::vector<std::pair<const char *, std::uint32_t> > &words, std::vector<char> &out) {
+    words.clear();
+    std::size_t bytes = 0;
+    const char *cursor = pos, *word;
+    std::size_t length;
+    while (nextWord(cursor, end, word, length)) {
+        const std::size_t needed = sizeof(std::uint32_t) * (words.size() + 3) + bytes + length;
+        if (!words.empty() && needed > capacity) break;
+        words.emplace_back(word, static_cast<std::uint32_t>(length));
+        bytes += length;
+        pos = cursor;
+    }
+    if (words.empty()) pos = end; // Only separators were left
+
+    const std::size_t start = out.size();
+    const std::size_t header = sizeof(std::uint32_t) * (words.size() + 2);
+    out.resize(start + header + bytes);
+    std::uint32_t *fields = reinterpret_cast<std::uint32_t *>(out.data() + start);
+    char *packed = out.data() + start + header;
+    fields[0] = static_cast<std::uint32_t>(words.size());
+    std::uint32_t offset = 0;
+    for (std::size_t i = 0; i < words.size(); i++) {
+        fields[i + 1] = offset;
+        std::memcpy(packed + offset, words[i].first, words[i].second);
+        offset += words[i].second;
+    }
+    fields[words.size() + 1] = offset;
+    return static_cast<int>(header + bytes);
+}
+
+// Function for the root to stream the corpus to every rank (itself included)
+// in rounds of variable-length word blocks, calling visit(batch) on each
+// rank for every block it receives. Round k + 1 is in flight with
+// MPI_Iscatterv while round k is being visited, and the root packs the next
+// round meanwhile. Memory stays at two blocks per rank, plus two rounds of
+// send buffers on the root, however big the corpus is. Block sizes travel
+// ahead of each round; STREAM_END closes the stream. If `readSeconds` is
+// given, the root adds the time it spends reading and packing blocks to it.
+template <typename Visitor>
+inline bool streamWords(const std::string &filename, int root, MPI_Comm comm, Visitor &&visit, double *readSeconds = nullptr) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    MappedFile file;
+    int ok = rank != root || file.open(filename);
+    MPI_Bcast(&ok, 1, MPI_INT, root, comm);
+    if (!ok) return false;
+
+    // Keep a whole round addressable with int displacements
+    const std::size_t capacity = std::min<std::size_t>(STREAM_BATCH_BYTES, INT_MAX / size);
+    const char *pos = file.data();
+    const char *end = pos + file.size();
+    std::vector<std::pair<const char *, std::uint32_t> > words;
+    std::vector<char> send[2], recv[2];
+    std::vector<int> sizes[2], displs[2];
+
+    auto packRound = [&](int slot) {
+        const double start = MPI_Wtime();
+        send[slot].clear();
+        sizes[slot].assign(size, STREAM_END);
+        displs[slot].assign(size, 0);
+        const bool finished = pos >= end;
+        for (int r = 0; r < size && !finished; r++) {
+            displs[slot][r] = static_cast<int>(send[slot].size());
+            sizes[slot][r] = packWordBatch(pos, end, capacity, words, send[slot]);
+        }
+        if (readSeconds != nullptr) *readSeconds += MPI_Wtime() - start;
+    };
+    if (rank == root) packRound(0);
+
+    for (int round = 0;; round++) {
+        const int slot = round & 1;
+        int blockBytes;
+        MPI_Scatter(rank == root ? sizes[slot].data() : nullptr, 1, MPI_INT, &blockBytes, 1, MPI_INT, root, comm);
+        if (blockBytes == STREAM_END) {
+            if (round > 0) visit(viewWordBatch(recv[slot ^ 1]));
+            break;
+        }
+
+        MPI_Request request;
+        recv[slot].resize(blockBytes);
+        MPI_Iscatterv(rank == root ? send[slot].data() : nullptr, rank == root ? sizes[slot].data() : nullptr,
+                      rank == root ? displs[slot].data() : nullptr, MPI_CHAR,
+                      recv[slot].data(), blockBytes, MPI_CHAR, root, comm, &request);
+        if (round > 0) visit(viewWordBatch(recv[slot ^ 1]));
+        if (rank == root) packRound(slot ^ 1);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+    }
+    return true;
+}
+
+#endif // WORD_STREAM_H